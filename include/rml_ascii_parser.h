@@ -0,0 +1,139 @@
+#ifndef RML_ASCII_PARSER_H
+#define RML_ASCII_PARSER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <rbl_utils.h>
+
+#include "rml_file.h"
+
+//! Parallel parser of line oriented records in ASCII files.
+//! File is mapped in to memory, requested lines are split in to chunks and
+//! each chunk is parsed on separate thread.
+//! Each line must contain exactly one record, otherwise parsing fails and
+//! caller is expected to fall back to sequential text stream reading.
+class RAsciiParser
+{
+
+    public:
+
+        //! Minimum number of lines for which parallel parsing is used.
+        static const uint minLines;
+        //! Number of lines in one chunk.
+        static const uint chunkSize;
+
+    private:
+
+        //! Private constructor.
+        explicit RAsciiParser() {}
+
+        //! Find offsets of line chunks.
+        //! Lines containing only white spaces are skipped.
+        //! Return offset after last line or negative value if file contains less lines.
+        static qint64 findLineChunks(const char *data,
+                                     qint64 size,
+                                     qint64 offset,
+                                     uint nLines,
+                                     std::vector<qint64> &chunkOffsets);
+
+    public:
+
+        //! Return true if character is a white space.
+        static inline bool isSpace(char c)
+        {
+            return (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v');
+        }
+
+        //! Return true if there are only white spaces between cursor and end.
+        static bool isBlank(const char *cursor, const char *end);
+
+        //! Find next token and move cursor behind it.
+        static bool findToken(const char *&cursor, const char *end, const char *&tokenBegin, const char *&tokenEnd);
+
+        //! Parse double value and move cursor behind it.
+        static bool parseDouble(const char *&cursor, const char *end, double &value);
+
+        //! Parse integer value and move cursor behind it.
+        //! Only decimal notation is accepted.
+        static bool parseInt(const char *&cursor, const char *end, int &value);
+
+        //! Parse unsigned integer value and move cursor behind it.
+        //! Only decimal notation is accepted.
+        static bool parseUInt(const char *&cursor, const char *end, uint &value);
+
+        //! Parse given number of lines starting at current text stream position.
+        //! Function parseLine(lineBegin,lineEnd,lineID) is called for each non-empty line
+        //! from multiple threads and must return false if line can not be parsed.
+        //! On success text stream is positioned behind last line and true is returned.
+        //! If number of lines is small, file can not be mapped or any line fails to parse
+        //! text stream position is not changed and false is returned.
+        template <typename F>
+        static bool parseLines(RFile &file, uint nLines, F parseLine)
+        {
+            if (nLines < RAsciiParser::minLines)
+            {
+                return false;
+            }
+
+            qint64 offset = file.getTextStream().pos();
+            qint64 size = file.size();
+            if (offset < 0 || size <= 0)
+            {
+                return false;
+            }
+
+            const char *data = (const char*)file.map(0,size);
+            if (!data)
+            {
+                return false;
+            }
+
+            std::vector<qint64> chunkOffsets;
+            qint64 endOffset = RAsciiParser::findLineChunks(data,size,offset,nLines,chunkOffsets);
+            std::atomic<bool> parsed(endOffset >= 0);
+
+            if (parsed)
+            {
+                int64_t nChunks = int64_t(chunkOffsets.size()) - 1;
+#pragma omp parallel for default(shared) schedule(dynamic)
+                for (int64_t i=0;i<nChunks;i++)
+                {
+                    uint lineID = uint(i) * RAsciiParser::chunkSize;
+                    uint lastLineID = std::min(nLines,lineID + RAsciiParser::chunkSize);
+                    qint64 position = chunkOffsets[i];
+                    while (lineID < lastLineID && parsed)
+                    {
+                        const char *lineBegin = data + position;
+                        const char *lineEnd = (const char*)std::memchr(lineBegin,'\n',size_t(size - position));
+                        if (!lineEnd)
+                        {
+                            lineEnd = data + size;
+                        }
+                        if (!RAsciiParser::isBlank(lineBegin,lineEnd))
+                        {
+                            if (!parseLine(lineBegin,lineEnd,lineID))
+                            {
+                                parsed = false;
+                            }
+                            lineID++;
+                        }
+                        position = qint64(lineEnd - data) + 1;
+                    }
+                }
+            }
+
+            file.unmap((uchar*)data);
+
+            if (!parsed)
+            {
+                return false;
+            }
+            return file.getTextStream().seek(endOffset);
+        }
+
+};
+
+#endif // RML_ASCII_PARSER_H
@@ -47,6 +47,9 @@ class RInterpolatedElement;
     _type == R_ELEMENT_HEXA1     \
 )
 
+//! Maximum number of nodes in element.
+#define R_ELEMENT_MAX_NODES 9
+
 #define R_ELEMENT_GROUP_TYPE_EQUALS(_type1,_type2) \
 ( \
     (R_ELEMENT_TYPE_IS_POINT(_type1)   && R_ELEMENT_TYPE_IS_POINT(_type2))   || \
@@ -74,6 +77,19 @@ typedef enum _RElementType
     R_ELEMENT_N_TYPES
 } RElementType;
 
+//! Canonical element key.
+//! Two elements have equal keys if they are of the same type and
+//! consist of the same nodes regardless of node order.
+typedef struct _RElementKey
+{
+    //! Element type.
+    RElementType type;
+    //! Number of nodes.
+    unsigned int nNodes;
+    //! Node IDs sorted in ascending order, unused positions are set to zero.
+    unsigned int nodeIDs[R_ELEMENT_MAX_NODES];
+} RElementKey;
+
 //! Element class.
 class RElement
 {
@@ -87,8 +103,11 @@ class RElement
 
         //! Element type.
         RElementType type;
+        //! Number of nodes.
+        unsigned int nNodes;
         //! List of node IDs (positions) in global node vecotr.
-        std::vector <unsigned int> nodeIDs;
+        //! Node IDs are stored inline, only first nNodes positions are used.
+        unsigned int nodeIDs[R_ELEMENT_MAX_NODES];
 
     public:
 
@@ -105,9 +124,11 @@ class RElement
         RElement & operator = ( const RElement &element );
 
         //! Equals operator.
+        //! Elements are equal if their canonical keys are equal.
         bool operator == ( const RElement &element ) const;
 
         //! Less than operator.
+        //! Elements are ordered by their canonical keys.
         bool operator < ( const RElement &element ) const;
 
         //! Get element type.
@@ -136,6 +157,9 @@ class RElement
         //! Check whether elemement has duplicate nodes (at least two nodes with same ID).
         bool hasDuplicateNodes ( void ) const;
 
+        //! Find canonical element key.
+        void findKey ( RElementKey &key ) const;
+
         //! Swap element normal (nodes).
         //! If element is not a surface element, nothing will be done and false is returned.
         bool swapNormal ( void );
@@ -213,6 +237,15 @@ class RElement
                             const RRVector &nodeValues,
                             const RRVector &volumes ) const;
 
+        //! Find interpolation ratios (weights) of element nodes.
+        //! Interpolated value is a sum of node values multiplied by ratios.
+        //! Volumes are the ones returned by isInside(), if empty they are computed.
+        //! For unsupported element types ratios are empty.
+        void findInterpolationRatios( const std::vector <RNode> &nodes,
+                                      const RNode &interpolatedNode,
+                                      const RRVector &volumes,
+                                      RRVector &ratios ) const;
+
         //! Find transformation matrix which provides rotation and translation from local to global coordinates.
         //! Return local (rotated) element coordinates.
         //! Rotate 2D elements into XY plane and 1D element into X axis.
@@ -313,9 +346,17 @@ class RElement
         //! Return number of nodes for given element type.
         static unsigned int getNNodes ( RElementType type );
 
+        //! Compare two element keys.
+        //! Return negative value if key1 is less than key2, zero if keys are equal and positive value otherwise.
+        static int compareKeys ( const RElementKey &key1, const RElementKey &key2 );
+
         //! Return number of possible neighbors for given element type.
         static unsigned int getNNeighbors ( RElementType type );
 
+        //! Return number of nodes shared by two neighbor elements of given type.
+        //! Zero is returned if neighbors can not be determined for given type.
+        static unsigned int getNSideNodes ( RElementType type );
+
         //! Return newly generated shape function information for given element type.
         static std::vector<RElementShapeFunction> generateShapeFunctionValues ( RElementType type );
 
@@ -0,0 +1,142 @@
+#ifndef RML_ELEMENT_TREE_H
+#define RML_ELEMENT_TREE_H
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include <rbl_utils.h>
+
+#include "rml_node.h"
+#include "rml_element.h"
+
+//! Axis aligned bounding box.
+typedef struct _RElementTreeBox
+{
+    double lower[3];
+    double upper[3];
+} RElementTreeBox;
+
+//! Bounding volume hierarchy node.
+typedef struct _RElementTreeNode
+{
+    //! Bounding box of all elements below this node.
+    RElementTreeBox box;
+    //! Position of first element (leaf node only).
+    uint first;
+    //! Number of elements (0 for inner node).
+    uint count;
+    //! Position of first child node, second child follows immediately (inner node only).
+    uint child;
+} RElementTreeNode;
+
+//! Bounding volume hierarchy over element limit boxes.
+//! Tree is used to quickly locate elements which may contain given point
+//! and to find pairs of elements which may intersect.
+class RElementTree
+{
+
+    public:
+
+        //! Maximum number of elements in leaf node.
+        static const uint leafSize;
+
+    protected:
+
+        //! Tree nodes, root node is at position 0.
+        std::vector<RElementTreeNode> treeNodes;
+        //! Element IDs ordered by leaf nodes.
+        std::vector<uint> elementIDs;
+        //! Element bounding boxes ordered same as element IDs.
+        std::vector<RElementTreeBox> elementBoxes;
+        //! Tree was built, published with release/acquire ordering.
+        std::atomic<bool> built;
+
+    private:
+
+        //! Internal initialization function.
+        void _init(const RElementTree *pElementTree = nullptr);
+
+        //! Recursively build tree node from elements at positions first to last (excluding).
+        void buildNode(uint nodeID, uint first, uint last, const std::vector<RElementTreeBox> &boxes, std::vector<uint> &order);
+
+        //! Recursively recompute bounding box of tree node from element boxes.
+        void refitNode(uint nodeID);
+
+        //! Find positions of elements whose bounding box intersects given box.
+        void findPositions(const RElementTreeBox &box, std::vector<uint> &positions, double tolerance) const;
+
+        //! Find positions of elements whose bounding box intersects given plane.
+        void findPositions(const RPlane &plane, std::vector<uint> &positions, double tolerance) const;
+
+    public:
+
+        //! Constructor.
+        RElementTree();
+
+        //! Copy constructor.
+        RElementTree(const RElementTree &elementTree);
+
+        //! Destructor.
+        ~RElementTree();
+
+        //! Assignment operator.
+        RElementTree &operator =(const RElementTree &elementTree);
+
+        //! Build tree over all elements.
+        void build(const std::vector<RNode> &nodes, const std::vector<RElement> &elements);
+
+        //! Build tree over given elements.
+        void build(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const std::vector<uint> &elementIDs);
+
+        //! Insert given elements in to already built tree.
+        //! New elements are placed in a separate subtree which is attached to the root.
+        void insert(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const std::vector<uint> &elementIDs);
+
+        //! Recompute bounding boxes after element nodes were moved or elements were modified.
+        //! Tree topology is kept unchanged.
+        void refit(const std::vector<RNode> &nodes, const std::vector<RElement> &elements);
+
+        //! Clear tree.
+        void clear(void);
+
+        //! Return true if tree was built.
+        bool isBuilt(void) const;
+
+        //! Find IDs of elements whose bounding box contains given node.
+        //! Resulting IDs are sorted in ascending order.
+        void findElementIDs(const RNode &node, std::vector<uint> &candidateIDs, double tolerance = RConstants::eps) const;
+
+        //! Find IDs of elements whose bounding box intersects given box.
+        //! Resulting IDs are sorted in ascending order.
+        void findElementIDs(const RElementTreeBox &box, std::vector<uint> &candidateIDs, double tolerance = RConstants::eps) const;
+
+        //! Find IDs of elements whose bounding box intersects given plane.
+        //! Only tree nodes straddling the plane are visited.
+        //! Resulting IDs are sorted in ascending order.
+        void findElementIDs(const RPlane &plane, std::vector<uint> &candidateIDs, double tolerance = RConstants::eps) const;
+
+        //! Find all pairs of elements with intersecting bounding boxes.
+        //! First ID in each pair is lower than second, pairs are sorted in ascending order.
+        void findElementPairs(std::vector< std::pair<uint,uint> > &elementPairs, double tolerance = RConstants::eps) const;
+
+        //! Find ID of first element (lowest ID) containing given node.
+        //! If no element is found RConstants::eod is returned.
+        uint findElementID(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const RNode &node) const;
+
+        //! Find element bounding box.
+        static void findElementBox(const std::vector<RNode> &nodes, const RElement &element, RElementTreeBox &box);
+
+        //! Return box enclosing both given boxes.
+        static RElementTreeBox findUnion(const RElementTreeBox &box1, const RElementTreeBox &box2);
+
+        //! Return true if boxes intersect within given tolerance.
+        static bool areIntersecting(const RElementTreeBox &box1, const RElementTreeBox &box2, double tolerance = 0.0);
+
+        //! Return true if box intersects plane within given tolerance.
+        //! Plane is given by its position and unit normal.
+        static bool isIntersecting(const RR3Vector &position, const RR3Vector &normal, const RElementTreeBox &box, double tolerance = 0.0);
+
+};
+
+#endif /* RML_ELEMENT_TREE_H */
@@ -11,6 +11,7 @@ typedef enum _RFileType
     R_FILE_TYPE_VIEW_FACTOR_MATRIX,
     R_FILE_TYPE_DISPLAY_PROPERTIES,
     R_FILE_TYPE_LINK,
+    R_FILE_TYPE_RESULTS,
     R_FILE_N_TYPES
 } RFileType;
 
@@ -31,6 +32,7 @@ class RFileHeader
         RFileType type;
         //! File information.
         //! If file is a link file this field will contain path to the file.
+        //! If file is a results file this field will contain path to the base model file.
         QString information;
 
     public:
@@ -1,7 +1,10 @@
 #ifndef RML_FILE_IO_H
 #define RML_FILE_IO_H
 
+#include <QtEndian>
+
 #include <rbl_book.h>
+#include <rbl_error.h>
 #include <rbl_ivector.h>
 #include <rbl_imatrix.h>
 
@@ -54,6 +57,13 @@ class RFileIO
 
     public:
 
+        //! Return true if file version uses block file layout introduced in version 1.3.0.
+        //! Block layout consists of section and variable offset index following binary model header,
+        //! nodes and elements stored in contiguous blocks with element type ID table,
+        //! block stored (optionally compressed) variable values, stored neighbor tables with connectivity hash
+        //! and stream line integrator settings.
+        static bool isBlockLayoutVersion(const RVersion &version);
+
         //! Write new line character.
         static void writeNewLineAscii(RSaveFile &outFile);
         static void writeNewLineAscii(RFile &outFile);
@@ -128,6 +138,35 @@ class RFileIO
         //! Write qsizetype value.
         static void writeBinary(RSaveFile &outFile, const qsizetype &sValue);
 
+        // std::vector<qsizetype>
+
+        //! Read qsizetype vector.
+        static void readBinary(RFile &inFile, std::vector<qsizetype> &sValues);
+        //! Write qsizetype vector.
+        static void writeBinary(RSaveFile &outFile, const std::vector<qsizetype> &sValues);
+
+        // QByteArray
+
+        //! Read byte array.
+        static void readBinary(RFile &inFile, QByteArray &bValues);
+        //! Write byte array.
+        static void writeBinary(RSaveFile &outFile, const QByteArray &bValues);
+
+        // Binary blocks
+
+        //! Read contiguous block of char values with single read call.
+        static void readBinaryBlock(RFile &inFile, char *cValues, qsizetype n);
+        //! Read contiguous block of little-endian unsigned int values with single read call.
+        static void readBinaryBlock(RFile &inFile, unsigned int *uValues, qsizetype n);
+        //! Read contiguous block of little-endian double values with single read call.
+        static void readBinaryBlock(RFile &inFile, double *dValues, qsizetype n);
+        //! Write contiguous block of char values with single write call.
+        static void writeBinaryBlock(RSaveFile &outFile, const char *cValues, qsizetype n);
+        //! Write contiguous block of unsigned int values in little-endian byte order with single write call.
+        static void writeBinaryBlock(RSaveFile &outFile, const unsigned int *uValues, qsizetype n);
+        //! Write contiguous block of double values in little-endian byte order with single write call.
+        static void writeBinaryBlock(RSaveFile &outFile, const double *dValues, qsizetype n);
+
         // QUuid
 
         //! Read string value.
@@ -346,6 +385,13 @@ class RFileIO
         //! Write RVariableApplyType.
         static void writeBinary(RSaveFile &outFile, const RVariableApplyType &variableApplyType);
 
+        // RVariableCompressionType
+
+        //! Read RVariableCompressionType.
+        static void readBinary(RFile &inFile, RVariableCompressionType &compressionType);
+        //! Write RVariableCompressionType.
+        static void writeBinary(RSaveFile &outFile, const RVariableCompressionType &compressionType);
+
         // RVariableData
 
         //! Read RVariableData.
@@ -363,6 +409,9 @@ class RFileIO
         static void readAscii(RFile &inFile, RVariable &variable);
         //! Read RVariable.
         static void readBinary(RFile &inFile, RVariable &variable);
+        //! Read RVariable header.
+        //! Value vectors are left empty and their values are skipped.
+        static void readBinaryHeader(RFile &inFile, RVariable &variable);
         //! Write RVariable.
         static void writeAscii(RSaveFile &outFile, const RVariable &variable, bool addNewLine = true);
         //! Write RVariable.
@@ -533,6 +582,26 @@ class RFileIO
         //! Write RElement.
         static void writeBinary(RSaveFile &outFile, const RElement &element);
 
+        // Node and element blocks
+
+        //! Read all nodes as one contiguous block of coordinates.
+        static void readBinaryBlock(RFile &inFile, std::vector<RNode> &nodes);
+        //! Write all nodes as one contiguous block of coordinates.
+        static void writeBinaryBlock(RSaveFile &outFile, const std::vector<RNode> &nodes);
+        //! Read header of element block, table of element type IDs and number of elements.
+        //! Element type ordinals stored in the block index the type table.
+        static void readBinaryElementBlockHeader(RFile &inFile, std::vector<RElementType> &typeTable, unsigned int &nElements);
+        //! Read all elements as contiguous blocks of element types and node IDs.
+        //! Element types are mapped through table of element type IDs stored in front of the blocks.
+        static void readBinaryBlock(RFile &inFile, std::vector<RElement> &elements);
+        //! Write all elements as contiguous blocks of element types and node IDs.
+        //! Element types are written as ordinals to table of element type IDs stored in front of the blocks.
+        static void writeBinaryBlock(RSaveFile &outFile, const std::vector<RElement> &elements);
+        //! Read neighbor table as contiguous blocks of neighbor counts and neighbor IDs.
+        static void readBinaryBlock(RFile &inFile, std::vector<RUVector> &neighbors);
+        //! Write neighbor table as contiguous blocks of neighbor counts and neighbor IDs.
+        static void writeBinaryBlock(RSaveFile &outFile, const std::vector<RUVector> &neighbors);
+
         // REntityGroupVariableDisplayType
 
         //! Read REntityGroupVariableDisplayType.
@@ -917,6 +986,8 @@ class RFileIO
 
             RFileIO::readAscii(inFile,nValues);
 
+            sparseVector.reserve(nValues);
+
             uint index = 0;
             T value;
 
@@ -925,7 +996,11 @@ class RFileIO
                 RFileIO::readAscii(inFile,index);
                 RFileIO::readAscii(inFile,value);
 
-                sparseVector.addValue(index,value);
+                // Values are written in ascending index order, sorted insert is needed only for malformed files.
+                if (!sparseVector.appendValue(index,value))
+                {
+                    sparseVector.addValue(index,value);
+                }
             }
         }
         //! Read RSparseVector.
@@ -937,15 +1012,34 @@ class RFileIO
 
             RFileIO::readBinary(inFile,nValues);
 
-            uint index = 0;
-            T value;
+            if (nValues == 0)
+            {
+                return;
+            }
 
+            // All index/value pairs are read with single read call.
+            const qsizetype itemSize = qsizetype(sizeof(uint) + sizeof(T));
+            if (qsizetype(nValues) > (inFile.size() - inFile.pos()) / itemSize)
+            {
+                throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid sparse vector size %u.",nValues);
+            }
+            std::vector<char> buffer(size_t(nValues) * size_t(itemSize));
+            RFileIO::readBinaryBlock(inFile,buffer.data(),qsizetype(buffer.size()));
+
+            sparseVector.reserve(nValues);
+
+            const char *item = buffer.data();
             for (uint i=0;i<nValues;i++)
             {
-                RFileIO::readBinary(inFile,index);
-                RFileIO::readBinary(inFile,value);
+                uint index = qFromLittleEndian<uint>(item);
+                T value = qFromLittleEndian<T>(item + sizeof(uint));
+                item += itemSize;
 
-                sparseVector.addValue(index,value);
+                // Values are written in ascending index order, sorted insert is needed only for malformed files.
+                if (!sparseVector.appendValue(index,value))
+                {
+                    sparseVector.addValue(index,value);
+                }
             }
         }
         //! Write RSparseVector.
@@ -980,11 +1074,19 @@ class RFileIO
 
             RFileIO::writeBinary(outFile,nValues);
 
+            // All index/value pairs are written with single write call.
+            const qsizetype itemSize = qsizetype(sizeof(uint) + sizeof(T));
+            std::vector<char> buffer(size_t(nValues) * size_t(itemSize));
+
+            char *item = buffer.data();
             for (uint i=0;i<nValues;i++)
             {
-                RFileIO::writeBinary(outFile,sparseVector.getIndex(i));
-                RFileIO::writeBinary(outFile,sparseVector.getValue(i));
+                qToLittleEndian<uint>(sparseVector.getIndex(i),item);
+                qToLittleEndian<T>(sparseVector.getValue(i),item + sizeof(uint));
+                item += itemSize;
             }
+
+            RFileIO::writeBinaryBlock(outFile,buffer.data(),qsizetype(buffer.size()));
         }
 
         // RPatch
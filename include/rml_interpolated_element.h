@@ -8,9 +8,23 @@
 #include "rml_element.h"
 #include "rml_variable.h"
 
-class RInterpolatedElement : public std::vector<RInterpolatedNode>
+//! Interpolated element.
+//! Nodes are held in fixed size inline buffer so that element does not allocate any memory.
+class RInterpolatedElement
 {
 
+    public:
+
+        //! Maximum number of nodes (all edges of tetrahedron intersected).
+        static const uint maxNodes = 6;
+
+    protected:
+
+        //! Nodes.
+        RInterpolatedNode nodes[maxNodes];
+        //! Number of nodes.
+        uint nNodes;
+
     private:
 
         //! Internal initialization function.
@@ -30,6 +44,57 @@ class RInterpolatedElement : public std::vector<RInterpolatedNode>
         //! Assignment operator.
         RInterpolatedElement & operator = ( const RInterpolatedElement &interpolatedElement );
 
+        //! Return number of nodes.
+        inline uint size ( void ) const
+        {
+            return this->nNodes;
+        }
+
+        //! Return true if element has no nodes.
+        inline bool empty ( void ) const
+        {
+            return (this->nNodes == 0);
+        }
+
+        //! Return const reference to node at given position.
+        inline const RInterpolatedNode & operator [] ( uint position ) const
+        {
+            return this->nodes[position];
+        }
+
+        //! Return reference to node at given position.
+        inline RInterpolatedNode & operator [] ( uint position )
+        {
+            return this->nodes[position];
+        }
+
+        //! Return const reference to node at given position.
+        const RInterpolatedNode & at ( uint position ) const;
+
+        //! Return reference to node at given position.
+        RInterpolatedNode & at ( uint position );
+
+        //! Return pointer to first node.
+        inline const RInterpolatedNode * begin ( void ) const
+        {
+            return this->nodes;
+        }
+
+        //! Return pointer behind last node.
+        inline const RInterpolatedNode * end ( void ) const
+        {
+            return this->nodes + this->nNodes;
+        }
+
+        //! Append node.
+        void push_back ( const RInterpolatedNode &node );
+
+        //! Remove all nodes.
+        inline void clear ( void )
+        {
+            this->nNodes = 0;
+        }
+
         //! Sort element nodes.
         void sortNodes ( void );
 
@@ -1,6 +1,7 @@
 #ifndef RML_INTERPOLATED_ENTITY_H
 #define RML_INTERPOLATED_ENTITY_H
 
+#include <algorithm>
 #include <vector>
 
 #include "rml_interpolated_element.h"
@@ -9,6 +10,11 @@
 class RInterpolatedEntity : public REntityGroup, public std::vector<RInterpolatedElement>
 {
 
+    public:
+
+        //! Number of source elements processed in one block by createElements.
+        static const uint blockSize;
+
     private:
 
         //! Internal initialization function.
@@ -28,6 +34,70 @@ class RInterpolatedEntity : public REntityGroup, public std::vector<RInterpolate
         //! Assignment operator.
         RInterpolatedEntity & operator = ( const RInterpolatedEntity &interpolatedEntity );
 
+        //! Replace interpolated elements with elements created for given number of source elements.
+        //! Function createElement(i) is called from multiple threads and must return
+        //! interpolated element for i-th source element, empty elements are dropped.
+        //! Order of created elements follows order of source elements regardless of number of threads.
+        template <typename F>
+        void createElements(uint nSourceElements, F createElement)
+        {
+            RInterpolatedEntity::createElements(std::vector<RInterpolatedEntity*>(1,this),nSourceElements,
+                                                [&](uint i, std::vector< std::vector<RInterpolatedElement> > &elements)
+            {
+                RInterpolatedElement iElement = createElement(i);
+                if (!iElement.empty())
+                {
+                    elements[0].push_back(iElement);
+                }
+            });
+        }
+
+        //! Replace interpolated elements of given entities in single sweep over source elements.
+        //! Function createSourceElements(i,elements) is called from multiple threads and must append
+        //! interpolated elements of i-th source element to elements[k] for k-th entity.
+        //! In first pass each block of source elements is processed and its elements are counted,
+        //! in second pass blocks are copied to their slots found from prefix sum of block counts.
+        //! Order of created elements follows order of source elements regardless of number of threads.
+        template <typename F>
+        static void createElements(const std::vector<RInterpolatedEntity*> &entities, uint nSourceElements, F createSourceElements)
+        {
+            int64_t nBlocks = (int64_t(nSourceElements) + RInterpolatedEntity::blockSize - 1) / RInterpolatedEntity::blockSize;
+
+            std::vector< std::vector< std::vector<RInterpolatedElement> > > blockElements(nBlocks);
+
+#pragma omp parallel for schedule(dynamic) default(shared)
+            for (int64_t i=0;i<nBlocks;i++)
+            {
+                uint first = uint(i) * RInterpolatedEntity::blockSize;
+                uint last = std::min(nSourceElements,first + RInterpolatedEntity::blockSize);
+                std::vector< std::vector<RInterpolatedElement> > &elements = blockElements[i];
+                elements.resize(entities.size());
+                for (uint j=first;j<last;j++)
+                {
+                    createSourceElements(j,elements);
+                }
+            }
+
+            for (size_t k=0;k<entities.size();k++)
+            {
+                std::vector<size_t> blockOffsets(nBlocks+1,0);
+                for (int64_t i=0;i<nBlocks;i++)
+                {
+                    blockOffsets[i+1] = blockOffsets[i] + blockElements[i][k].size();
+                }
+
+                std::vector<RInterpolatedElement> &entityElements = *entities[k];
+                entityElements.clear();
+                entityElements.resize(blockOffsets[nBlocks]);
+
+#pragma omp parallel for default(shared)
+                for (int64_t i=0;i<nBlocks;i++)
+                {
+                    std::copy(blockElements[i][k].begin(),blockElements[i][k].end(),entityElements.begin() + blockOffsets[i]);
+                }
+            }
+        }
+
 };
 
 #endif /* RML_INTERPOLATED_ENTITY_H */
@@ -0,0 +1,162 @@
+#ifndef RML_MAPPED_MODEL_H
+#define RML_MAPPED_MODEL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+
+#include <vector>
+
+#include "rml_element.h"
+#include "rml_file.h"
+#include "rml_node.h"
+#include "rml_variable.h"
+
+//! Read-only view of contiguous block of little-endian values in mapped file.
+template <typename T>
+class RMappedBlock
+{
+
+    protected:
+
+        //! Pointer to first value in mapped memory.
+        const uchar *data;
+        //! Number of values.
+        qsizetype n;
+
+    public:
+
+        //! Constructor.
+        RMappedBlock(const uchar *data = nullptr, qsizetype n = 0)
+            : data(data)
+            , n(n)
+        {
+        }
+
+        //! Return number of values.
+        inline qsizetype size(void) const
+        {
+            return this->n;
+        }
+
+        //! Return value at given position.
+        //! Value is loaded from mapped memory, no alignment is required.
+        inline T operator [](qsizetype i) const
+        {
+            return qFromLittleEndian<T>(this->data + i*qsizetype(sizeof(T)));
+        }
+
+};
+
+//! Binary model file mapped in to memory.
+//! Nodes, element connectivity and variable values are not loaded,
+//! they are accessed directly in mapped file and paged in on first touch.
+//! Values of compressed variables are decompressed in to memory when file is opened.
+//! Only binary model files of version 1.3.0 and newer can be mapped.
+class RMappedModel
+{
+
+    protected:
+
+        //! Mapped file.
+        RFile *pFile;
+        //! Pointer to mapped memory.
+        const uchar *pData;
+        //! Model name.
+        QString name;
+        //! Model description.
+        QString description;
+        //! Node coordinates.
+        RMappedBlock<double> nodeCoordinates;
+        //! Element type table indexed by element type ordinals.
+        std::vector<RElementType> elementTypeTable;
+        //! Element type ordinals.
+        RMappedBlock<uchar> elementTypes;
+        //! Element node IDs.
+        RMappedBlock<uint> elementNodeIDs;
+        //! Position of first node ID of each element.
+        //! Offsets are computed on first element access.
+        mutable std::vector<qsizetype> elementOffsets;
+        //! Variables with value vectors of zero size.
+        std::vector<RVariable> variables;
+        //! Variable values.
+        std::vector< std::vector< RMappedBlock<double> > > variableValues;
+        //! Decompressed values of compressed variables.
+        //! Variable value blocks of compressed variables point in to these buffers.
+        std::vector<QByteArray> decompressedValues;
+
+    private:
+
+        //! Copy constructor.
+        RMappedModel(const RMappedModel &mappedModel);
+
+        //! Assignment operator.
+        RMappedModel &operator =(const RMappedModel &mappedModel);
+
+        //! Return mapped block starting at current file position and skip it.
+        template <typename T>
+        RMappedBlock<T> mapBlock(qsizetype n);
+
+        //! Compute element offsets.
+        void findElementOffsets(void) const;
+
+    public:
+
+        //! Constructor.
+        RMappedModel();
+
+        //! Destructor.
+        ~RMappedModel();
+
+        //! Open and map binary model file.
+        void open(const QString &fileName);
+
+        //! Unmap and close file.
+        void close(void);
+
+        //! Return true if file is mapped.
+        bool isOpen(void) const;
+
+        //! Return model name.
+        const QString &getName(void) const;
+
+        //! Return model description.
+        const QString &getDescription(void) const;
+
+        //! Return number of nodes.
+        uint getNNodes(void) const;
+
+        //! Return node.
+        RNode getNode(uint nodeID) const;
+
+        //! Return view of node coordinates (x,y,z for each node).
+        const RMappedBlock<double> &getNodeCoordinates(void) const;
+
+        //! Return number of elements.
+        uint getNElements(void) const;
+
+        //! Return element type.
+        RElementType getElementType(uint elementID) const;
+
+        //! Return element.
+        RElement getElement(uint elementID) const;
+
+        //! Return number of variables.
+        uint getNVariables(void) const;
+
+        //! Return variable position for given variable type.
+        //! If no such variable exists RConstants::eod is returned.
+        uint findVariable(RVariableType variableType) const;
+
+        //! Return variable header, its value vectors are of zero size.
+        const RVariable &getVariableHeader(uint position) const;
+
+        //! Return view of variable values for given vector position.
+        const RMappedBlock<double> &getVariableValues(uint position, uint vecpos) const;
+
+        //! Return variable with values copied from mapped file.
+        RVariable getVariable(uint position) const;
+
+};
+
+#endif // RML_MAPPED_MODEL_H
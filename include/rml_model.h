@@ -1,6 +1,9 @@
 #ifndef RML_MODEL_H
 #define RML_MODEL_H
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <vector>
 
 #include <rbl_bvector.h>
@@ -10,9 +13,13 @@
 
 #include "rml_cut.h"
 #include "rml_element.h"
+#include "rml_element_tree.h"
+#include "rml_file.h"
 #include "rml_iso.h"
 #include "rml_line.h"
 #include "rml_node.h"
+#include "rml_node_grid.h"
+#include "rml_node_incidence.h"
 #include "rml_patch_book.h"
 #include "rml_patch_input.h"
 #include "rml_point.h"
@@ -40,6 +47,20 @@ typedef enum _RModelProblemType
 
 typedef int RModelProblemTypeMask;
 
+//! Sections of binary model file.
+//! Offsets of sections and variables are stored in section index following the file header.
+typedef enum _RModelFileSection
+{
+    R_MODEL_FILE_SECTION_MESH = 0,
+    R_MODEL_FILE_SECTION_ENTITY_GROUPS,
+    R_MODEL_FILE_SECTION_INTERPOLATED_ENTITIES,
+    R_MODEL_FILE_SECTION_MODEL_DATA,
+    R_MODEL_FILE_SECTION_PROBLEM,
+    R_MODEL_FILE_SECTION_RESULTS,
+    R_MODEL_FILE_SECTION_NEIGHBORS,
+    R_MODEL_FILE_N_SECTIONS
+} RModelFileSection;
+
 
 //! Model class.
 class RModel : public RProblem, public RResults
@@ -54,6 +75,22 @@ class RModel : public RProblem, public RResults
         void addElementToGroup(uint elementID,
                                  uint groupID = 0);
 
+        //! Return current mesh revision.
+        uint64_t getMeshRevision() const;
+
+        //! Calculate missing neighbor tables if they are pending.
+        void findPendingNeighbors() const;
+
+        //! Return mask of elements belonging to given element groups, mask is built if needed.
+        std::shared_ptr<const std::vector<bool>> getElementGroupMask(const std::vector<uint> &elementGroupIDs) const;
+
+        //! Return node search grid for given tolerance, grid is built if needed.
+        std::shared_ptr<const RNodeGrid> getNodeGrid(double tolerance) const;
+
+        //! Clear node to element incidence if it was built for older mesh revision.
+        //! Must be called before incidence is patched by mutator.
+        void clearStaleNodeIncidence();
+
     protected:
 
         //! Model name.
@@ -83,9 +120,39 @@ class RModel : public RProblem, public RResults
         //! List of all isos.
         std::vector <RIso> isos;
         //! Surface neighbors.
-        std::vector<RUVector> surfaceNeigs;
+        mutable std::vector<RUVector> surfaceNeigs;
         //! Volume neighbors.
-        std::vector<RUVector> volumeNeigs;
+        mutable std::vector<RUVector> volumeNeigs;
+        //! Missing neighbor tables are to be calculated on first access.
+        mutable std::atomic<bool> neighborsPending;
+        //! Element search tree (built on first use).
+        mutable RElementTree elementTree;
+        //! Mesh revision the element search tree was built for (0 = not built).
+        mutable std::atomic<uint64_t> elementTreeRevision;
+        //! Node search grid (built on first use, shared with running queries).
+        mutable std::shared_ptr<const RNodeGrid> nodeGrid;
+        //! Mesh revision the node search grid was built for (0 = not built).
+        mutable uint64_t nodeGridRevision;
+        //! Element masks of element group sets keyed by group IDs and sizes (built on first use, shared with running queries).
+        mutable std::map< std::vector<uint>,std::shared_ptr<const std::vector<bool>> > elementGroupMasks;
+        //! Mesh revision the element group masks were built for (0 = not built).
+        mutable uint64_t elementGroupMasksRevision;
+        //! Content hash of the mesh.
+        mutable QByteArray meshHash;
+        //! Mesh revision the mesh hash was computed for (0 = not computed).
+        mutable uint64_t meshHashRevision;
+        //! Content hash of element connectivity.
+        mutable QByteArray connectivityHash;
+        //! Mesh revision the connectivity hash was computed for (0 = not computed).
+        mutable uint64_t connectivityHashRevision;
+        //! Mesh revision, increased after mesh was marked as modified.
+        mutable std::atomic<uint64_t> meshRevision;
+        //! Mesh was marked as modified since last mesh revision.
+        mutable std::atomic<bool> meshModified;
+        //! Node to element incidence (built on first use).
+        mutable RNodeIncidence nodeIncidence;
+        //! Mesh revision the node to element incidence was built for (0 = not built).
+        mutable std::atomic<uint64_t> nodeIncidenceRevision;
         //! Display properties.
         RModelData modelData;
 
@@ -120,11 +187,26 @@ class RModel : public RProblem, public RResults
         void update(const RModel &rModel);
 
         //! Read mesh from the file.
-        void read(const QString &fileName);
+        //! If loadVariablesOnDemand is true variable values of binary file are loaded on first variable access.
+        void read(const QString &fileName, bool loadVariablesOnDemand = false);
 
         //! Write mesh to the file.
+        //! If baseFileName is given and file is binary only results are written together with
+        //! reference to base model file which must contain the same mesh.
         //! Return actual filename to which the model was saved.
-        QString write(const QString &fileName, bool writeLinkFile = true) const;
+        QString write(const QString &fileName, bool writeLinkFile = true, const QString &baseFileName = QString()) const;
+
+        //! Return copy of the model holding data written by write() with same file names.
+        //! Caches are not copied. If only results are written, mesh is not copied and only its hash is kept.
+        RModel createWriteSnapshot(const QString &fileName, const QString &baseFileName = QString()) const;
+
+        //! Return content hash of the mesh (nodes and elements).
+        //! Hash is cached until the mesh is modified.
+        QByteArray findMeshHash() const;
+
+        //! Return content hash of element connectivity (element types and node IDs).
+        //! Hash is cached until the mesh is modified.
+        QByteArray findConnectivityHash() const;
 
         //! Export model to MSH (old range) model.
         void exportTo(RModelMsh &modelMsh) const;
@@ -174,12 +256,14 @@ class RModel : public RProblem, public RResults
         const RNode * getNodePtr(uint position) const;
 
         //! Return pointer to node in model at given position.
+        //! Modification through returned pointer must be followed by setMeshModified().
         RNode * getNodePtr(uint position);
 
         //! Return reference to node in model at given position.
         const RNode &getNode(uint position) const;
 
         //! Return reference to node in model at given position.
+        //! Modification through returned reference must be followed by setMeshModified().
         RNode &getNode(uint position);
 
         //! Return const reference to array of all nodes.
@@ -204,6 +288,11 @@ class RModel : public RProblem, public RResults
         //! Merge two nodes.
         void mergeNodes(uint position1, uint position2, bool average, bool allowDowngrade);
 
+        //! Merge nodes according to merge map in a single sweep.
+        //! Each node is merged in to node given by mergeMap, target node must be mapped on itself.
+        //! Return number of merged nodes.
+        uint mergeNodes(const std::vector<uint> &mergeMap, bool allowDowngrade);
+
         //! Find near node positions.
         //! Return vector of node positions in model whose
         //! distance from node is smaller than specified distance.
@@ -262,20 +351,27 @@ class RModel : public RProblem, public RResults
         const RElement *getElementPtr(uint position) const;
 
         //! Return pointer to element in model at given position.
+        //! Modification through returned pointer must be followed by setMeshModified().
         RElement * getElementPtr(uint position);
 
         //! Return reference to element in model at given position.
         const RElement &getElement(uint position) const;
 
         //! Return reference to element in model at given position.
+        //! Modification through returned reference must be followed by setMeshModified().
         RElement &getElement(uint position);
 
         //! Return const reference to array of all elements.
         const std::vector <RElement> &getElements() const;
 
         //! Return reference to array of all elements.
+        //! Modification through returned reference must be followed by setMeshModified().
         std::vector <RElement> &getElements();
 
+        //! Mark mesh as modified in place.
+        //! Element search tree, node incidence, node grid and mesh hashes are rebuilt on next use.
+        void setMeshModified();
+
         //! Add element to model.
         void addElement(const RElement &element, bool addToGroup = false, uint groupID = 0);
 
@@ -294,6 +390,36 @@ class RModel : public RProblem, public RResults
         //! node.
         std::vector<uint> findElementPositionsByNodeId(uint nodeID) const;
 
+        //! Find ID of element containing given node.
+        //! Only elements belonging to given entity group types are considered.
+        //! If no element is found RConstants::eod is returned.
+        uint findElementContaining(const RNode &rNode, REntityGroupTypeMask entityGroup = R_ENTITY_GROUP_ELEMENT) const;
+
+        //! Find ID of element containing given node and return its interpolation volumes.
+        uint findElementContaining(const RNode &rNode, REntityGroupTypeMask entityGroup, RRVector &volumes) const;
+
+        //! Find IDs of elements containing given nodes and return their interpolation volumes.
+        //! Nodes are processed in spatial order and element found for previous node is used as a start
+        //! for search of the next one.
+        //! For node outside of the model RConstants::eod is returned.
+        std::vector<uint> findElementsContaining(const std::vector<RNode> &nodes,
+                                                 REntityGroupTypeMask entityGroup,
+                                                 std::vector<RRVector> &volumes) const;
+
+        //! Return element search tree, tree is built if needed.
+        const RElementTree &getElementTree() const;
+
+        //! Invalidate element search tree, node search grid and mesh hashes.
+        //! Tree is rebuilt automatically after nodes or elements were accessed through non-const references.
+        void invalidateElementTree();
+
+        //! Return node to element incidence, incidence is built if needed.
+        const RNodeIncidence &getNodeIncidence() const;
+
+        //! Invalidate node to element incidence.
+        //! Incidence is rebuilt automatically after elements were accessed through non-const references.
+        void invalidateNodeIncidence();
+
         //! Find line element size statistics.
         RStatistics findLineElementSizeStatistics() const;
 
@@ -730,6 +856,13 @@ class RModel : public RProblem, public RResults
                                               const RNode &rNode,
                                               REntityGroupTypeMask entityGroup = R_ENTITY_GROUP_ELEMENT) const;
 
+        //! Return results vectors for given nodes.
+        //! Elements containing nodes are found by findElementsContaining().
+        //! For node outside of the model empty vector is returned.
+        std::vector<RRVector> getInterpolatedResultsValues(RVariableType variableType,
+                                                           const std::vector<RNode> &nodes,
+                                                           REntityGroupTypeMask entityGroup = R_ENTITY_GROUP_ELEMENT) const;
+
 
         /*************************************************************
          * Geometry transformation                                   *
@@ -785,9 +918,17 @@ class RModel : public RProblem, public RResults
         //! Create interpolated entity from variable type, variable value and list of element IDs.
         void createIso(RIso &rIso) const;
 
+        //! Create multiple iso interpolated entities in single sweep over elements.
+        //! Isos with same variable type and element groups share gathering of element node values.
+        void createIsos(const std::vector<RIso *> &rIsos) const;
+
         //! Create interpolated entity from variable type, variable value.
         void createStreamLine(RStreamLine &rStreamLine) const;
 
+        //! Create multiple stream line interpolated entities.
+        //! Start elements are located together and stream lines are traced concurrently.
+        void createStreamLines(const std::vector<RStreamLine *> &rStreamLines) const;
+
         //! Recreate dependent entities such as cuts or isos.
         void createDependentEntities();
 
@@ -931,7 +1072,7 @@ class RModel : public RProblem, public RResults
 
         //! Read from the binary file.
         //! If file is a link target filename is returned.
-        QString readBinary(const QString &fileName);
+        QString readBinary(const QString &fileName, bool loadVariablesOnDemand = false);
 
         //! Write to the ASCII file.
         void writeAscii(const QString &fileName) const;
@@ -939,6 +1080,13 @@ class RModel : public RProblem, public RResults
         //! Write to the binary file.
         void writeBinary(const QString &fileName) const;
 
+        //! Read results from the binary results file.
+        //! Base model file is read first unless its mesh is already loaded.
+        void readBinaryResults(RFile &modelFile, const QString &fileName, const QString &baseFileName, bool loadVariablesOnDemand);
+
+        //! Write results to the binary results file referring to base model file.
+        void writeBinaryResults(const QString &fileName, const QString &baseFileName) const;
+
     protected:
 
         //! Find surface neighbors book.
@@ -947,6 +1095,62 @@ class RModel : public RProblem, public RResults
         //! Find volume neighbors book.
         std::vector<RUVector> findVolumeNeighbors() const;
 
+        //! Find neighbors book for elements of given group type.
+        //! Neighbors are found by sorting keys of shared sides, neighbor lists are sorted in ascending order.
+        std::vector<RUVector> findElementNeighbors(REntityGroupType elementGroupType) const;
+
+        //! Find interpolated results vector for node inside given element.
+        RRVector findInterpolatedResultsValues(const RVariable &rVariable,
+                                               uint elementID,
+                                               const RNode &rNode,
+                                               const RRVector &volumes) const;
+
+        //! Find ID of element containing given node.
+        //! Given element and elements sharing a node with it are tested first.
+        uint findElementContaining(const RNode &rNode,
+                                   REntityGroupTypeMask entityGroup,
+                                   uint startElementID,
+                                   RRVector &volumes) const;
+
+        //! Find normalized vector variable direction at given node inside given element.
+        //! Return false if variable vector is zero.
+        bool findStreamLineDirection(const RVariable &rVariable,
+                                     uint elementID,
+                                     const RNode &rNode,
+                                     const RRVector &volumes,
+                                     RRVector &ratios,
+                                     RR3Vector &direction) const;
+
+        //! Find position after one fourth order Runge-Kutta step of given length along stream line.
+        //! Element ID is a start for element search and is updated to element containing new position.
+        //! Return false if any stage leaves volume elements or hits zero vector.
+        bool findStreamLineStep(const RVariable &rVariable,
+                                const RR3Vector &position,
+                                double step,
+                                uint &elementID,
+                                RRVector &volumes,
+                                RRVector &ratios,
+                                RR3Vector &nextPosition) const;
+
+        //! Trace stream line by walking through element neighbors.
+        void traceStreamLine(RStreamLine &rStreamLine,
+                             const RVariable &rVariable,
+                             uint elementID,
+                             RRVector &volumes,
+                             RRVector &ratios) const;
+
+        //! Trace stream line with fourth order Runge-Kutta integrator with step size control.
+        void traceStreamLineRungeKutta(RStreamLine &rStreamLine,
+                                       const RVariable &rVariable,
+                                       uint elementID,
+                                       RRVector &volumes,
+                                       RRVector &ratios) const;
+
+        //! Find duplicate elements among given elements.
+        //! Elements are duplicate if they have equal canonical keys, first occurrence is not reported.
+        //! Resulting IDs are sorted in ascending order.
+        std::vector<uint> findDuplicateElements(const std::vector<uint> &elementIDs) const;
+
         //! Find volume elements neighbor position.
         uint findVolumeNeighborPosition(uint elementID, uint neighborID) const;
 
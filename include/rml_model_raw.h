@@ -8,6 +8,7 @@
 
 #include "rml_node.h"
 #include "rml_element.h"
+#include "rml_node_grid.h"
 
 //! Raw triangulated surface class.
 class RModelRaw
@@ -26,6 +27,12 @@ class RModelRaw
         //! List of elements.
         std::vector<RElement> elements;
 
+        //! Node search grid used by findNearNode.
+        mutable RNodeGrid nodeGrid;
+
+        //! Number of nodes registered in node search grid.
+        mutable unsigned int nGridNodes;
+
         //! Find near node to the given node.
         //! If no node was found a RConstants::eod is returned.
         unsigned int findNearNode ( const RNode &node,
@@ -27,14 +27,27 @@ class RModelStl : public RModelRaw
         //! Check if file contains binary information.
         bool checkIfBinary ( const QString &fileName ) const;
 
+        //! Return ID of node closer to given node than weld grid tolerance.
+        //! If there is no such node, given node is appended to nodes and inserted in to weld grid.
+        static unsigned int weldNode ( RNodeGrid          &weldGrid,
+                                       std::vector<RNode> &nodes,
+                                       const RNode        &node );
+
         //! Read surface mesh from binary file.
+        //! Facets are read in large blocks and vertices closer than tolerance are welded while reading.
         void readBinary ( const QString &fileName,
                           double         tolerance = 0.0 );
 
         //! Write surface mesh to binary file.
         void writeBinary ( const QString &fileName ) const;
 
+        //! Return true if token matches keyword regardless of case.
+        static bool isKeyword ( const char *tokenBegin,
+                                const char *tokenEnd,
+                                const char *keyword );
+
         //! Read surface mesh from ASCII file.
+        //! File is tokenized directly in memory and vertices closer than tolerance are welded while reading.
         void readAscii ( const QString &fileName,
                          double         tolerance = 0.0 );
 
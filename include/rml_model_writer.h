@@ -0,0 +1,97 @@
+#ifndef RML_MODEL_WRITER_H
+#define RML_MODEL_WRITER_H
+
+#include <QString>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rml_model.h"
+
+//! Background model writer.
+//! Model snapshot (see RModel::createWriteSnapshot) is taken on the caller thread and written by RModel::write on a dedicated I/O thread,
+//! so files are still committed atomically through RSaveFile.
+//! Requests are written in the order in which they were submitted.
+//! Number of queued requests is bounded, when queue is full write() blocks until space is available.
+class RModelWriter
+{
+
+    public:
+
+        //! Default maximum number of queued requests.
+        static const uint defaultQueueSize;
+
+    protected:
+
+        //! Write request.
+        struct Request
+        {
+            //! Model snapshot.
+            RModel model;
+            //! File name.
+            QString fileName;
+            //! Write link file.
+            bool writeLinkFile;
+            //! Base model file name.
+            QString baseFileName;
+            //! Promise of written file name.
+            std::promise<QString> promise;
+        };
+
+        //! Maximum number of queued requests.
+        uint queueSize;
+        //! Queued requests.
+        std::deque< std::shared_ptr<Request> > queue;
+        //! Number of requests being written.
+        uint nActive;
+        //! Stop flag.
+        bool stopRequested;
+        //! Mutex protecting queue and flags.
+        mutable std::mutex mutex;
+        //! Signaled when queue or flags change.
+        std::condition_variable condition;
+        //! I/O thread.
+        std::thread thread;
+
+    private:
+
+        //! Copy constructor.
+        RModelWriter(const RModelWriter &modelWriter);
+
+        //! Assignment operator.
+        RModelWriter &operator =(const RModelWriter &modelWriter);
+
+        //! I/O thread loop.
+        void run(void);
+
+    public:
+
+        //! Constructor.
+        explicit RModelWriter(uint queueSize = RModelWriter::defaultQueueSize);
+
+        //! Destructor.
+        //! All queued requests are written before destruction completes.
+        ~RModelWriter();
+
+        //! Submit model to be written.
+        //! Parameters have same meaning as in RModel::write.
+        //! Returned future holds actual filename to which the model was saved
+        //! or rethrows exception raised while writing.
+        std::shared_future<QString> write(const RModel &model,
+                                          const QString &fileName,
+                                          bool writeLinkFile = true,
+                                          const QString &baseFileName = QString());
+
+        //! Block until all submitted requests are written.
+        void flush(void);
+
+        //! Return number of requests which were not written yet.
+        uint getNPending(void) const;
+
+};
+
+#endif // RML_MODEL_WRITER_H
@@ -1,7 +1,10 @@
 #ifndef RML_NODE_H
 #define RML_NODE_H
 
+#include <vector>
+
 #include <rbl_r3vector.h>
+#include <rbl_utils.h>
 
 //! Node class
 class RNode
@@ -34,10 +37,11 @@ class RNode
         RNode ( const RR3Vector &vector );
 
         //! Copy constructor
-        RNode ( const RNode &node );
+        //! Node is trivially copyable so that node vectors are copied as plain memory.
+        RNode ( const RNode &node ) = default;
 
         //! Destructor
-        ~RNode ();
+        ~RNode () = default;
 
         //! Return x coordinate
         inline double getX ( void ) const
@@ -109,7 +113,7 @@ class RNode
         void scale ( const RR3Vector &scaleVector );
 
         //! Assignment operator
-        RNode & operator = ( const RNode &node );
+        RNode & operator = ( const RNode &node ) = default;
 
         //! Equal operator.
         bool operator == ( const RNode &node ) const;
@@ -129,6 +133,35 @@ class RNode
         //! Print node to standard output.
         void print ( void ) const;
 
+        //! Find coordinate limits of all nodes.
+        //! If node vector is empty all limits are set to zero.
+        static void findNodeLimits ( const std::vector<RNode> &nodes,
+                                     double &xmin, double &xmax,
+                                     double &ymin, double &ymax,
+                                     double &zmin, double &zmax );
+
+        //! Transform given nodes (x = R * (x + t1) + t2).
+        static void transformNodes ( std::vector<RNode> &nodes,
+                                     const std::vector<uint> &nodeIDs,
+                                     const RRMatrix &R,
+                                     const RR3Vector &t1,
+                                     const RR3Vector &t2 );
+
+        //! Translate given nodes.
+        static void translateNodes ( std::vector<RNode> &nodes,
+                                     const std::vector<uint> &nodeIDs,
+                                     const RR3Vector &t );
+
+        //! Scale given nodes around center.
+        static void scaleNodes ( std::vector<RNode> &nodes,
+                                 const std::vector<uint> &nodeIDs,
+                                 const RR3Vector &scaleVector,
+                                 const RR3Vector &center );
+
+        //! Scale all nodes.
+        static void scaleNodes ( std::vector<RNode> &nodes,
+                                 double scale );
+
         //! Allow RFileIO to access private members.
         friend class RFileIO;
 
@@ -0,0 +1,104 @@
+#ifndef RML_NODE_GRID_H
+#define RML_NODE_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <rbl_utils.h>
+
+#include "rml_node.h"
+
+//! Uniform spatial hash grid over node positions.
+//! Grid stores only node IDs, coordinates are always taken from the node vector passed to the query.
+class RNodeGrid
+{
+
+    public:
+
+        //! Minimum cell size.
+        static const double minCellSize;
+
+    protected:
+
+        //! Tolerance, nodes closer than or equal to tolerance are considered near.
+        double tolerance;
+        //! Grid cell size.
+        double cellSize;
+        //! Map of cell keys to node IDs.
+        std::unordered_map< uint64_t,std::vector<uint> > cells;
+
+    private:
+
+        //! Internal initialization function.
+        void _init(const RNodeGrid *pNodeGrid = nullptr);
+
+        //! Compute cell index along one axis.
+        int64_t findCellIndex(double value) const;
+
+        //! Compute cell key from cell indexes.
+        static uint64_t findCellKey(int64_t ix, int64_t iy, int64_t iz);
+
+    public:
+
+        //! Constructor.
+        //! Cell size is never smaller than tolerance or minimum cell size.
+        RNodeGrid(double tolerance = 0.0, double cellSize = 0.0);
+
+        //! Copy constructor.
+        RNodeGrid(const RNodeGrid &nodeGrid);
+
+        //! Destructor.
+        ~RNodeGrid();
+
+        //! Assignment operator.
+        RNodeGrid &operator =(const RNodeGrid &nodeGrid);
+
+        //! Return tolerance.
+        double getTolerance(void) const;
+
+        //! Reserve space for given number of nodes.
+        void reserve(uint nNodes);
+
+        //! Clear grid.
+        void clear(void);
+
+        //! Insert node ID at position of given node.
+        void insert(const RNode &node, uint nodeID);
+
+        //! Insert all nodes.
+        void insert(const std::vector<RNode> &nodes);
+
+        //! Find near node.
+        //! If findNearest is false node with lowest ID within tolerance is returned, otherwise the nearest one.
+        //! If strict is true node distance must be smaller than tolerance.
+        //! Node with ID equal to excludeID is skipped.
+        //! If no node was found a RConstants::eod is returned.
+        uint findNearNode(const std::vector<RNode> &nodes,
+                          const RNode &node,
+                          bool findNearest = false,
+                          bool strict = false,
+                          uint excludeID = RConstants::eod) const;
+
+        //! Find all node IDs whose distance from node is smaller than tolerance.
+        //! Resulting IDs are sorted in ascending order.
+        std::vector<uint> findNearNodes(const std::vector<RNode> &nodes, const RNode &node) const;
+
+        //! Find merge map of near nodes.
+        //! Each node is mapped on the lowest node ID within tolerance which is not mapped itself.
+        //! Unmerged nodes are mapped on themselves.
+        //! Return number of merged nodes.
+        static uint findMergeMap(const std::vector<RNode> &nodes, double tolerance, std::vector<uint> &mergeMap);
+
+        //! Convert merge map in to compact renumbering book.
+        //! Target node of each merged node must be mapped on itself.
+        //! Merged nodes receive new ID of their target node, removeBook contains RConstants::eod for removed nodes.
+        //! Return number of remaining nodes.
+        static uint findNodeBook(const std::vector<uint> &mergeMap, std::vector<uint> &nodeBook, std::vector<uint> &removeBook);
+
+        //! Compute suitable cell size for given nodes and tolerance.
+        static double findCellSize(const std::vector<RNode> &nodes, double tolerance);
+
+};
+
+#endif /* RML_NODE_GRID_H */
@@ -0,0 +1,94 @@
+#ifndef RML_NODE_INCIDENCE_H
+#define RML_NODE_INCIDENCE_H
+
+#include <atomic>
+#include <vector>
+
+#include <rbl_utils.h>
+
+#include "rml_element.h"
+
+//! Node to element incidence (inverse connectivity).
+//! Element IDs of each node are stored in one row of a flat array (CSR like layout).
+//! Rows are kept sorted in ascending order and have some spare capacity so that
+//! single element and node modifications can be patched without full rebuild.
+class RNodeIncidence
+{
+
+    protected:
+
+        //! Position of first row entry in element ID array.
+        std::vector<uint> rowStart;
+        //! Number of entries in row.
+        std::vector<uint> rowSize;
+        //! Number of reserved entries in row.
+        std::vector<uint> rowCapacity;
+        //! Flat array of element IDs.
+        std::vector<uint> elementIDs;
+        //! Number of nodes the incidence was built for.
+        uint nNodes;
+        //! Number of elements the incidence was built for.
+        uint nElements;
+        //! Incidence was built, published with release/acquire ordering.
+        std::atomic<bool> built;
+
+    private:
+
+        //! Internal initialization function.
+        void _init(const RNodeIncidence *pNodeIncidence = nullptr);
+
+        //! Insert element ID in to node row.
+        void insert(uint nodeID, uint elementID);
+
+        //! Erase element ID from node row.
+        void erase(uint nodeID, uint elementID);
+
+    public:
+
+        //! Constructor.
+        RNodeIncidence();
+
+        //! Copy constructor.
+        RNodeIncidence(const RNodeIncidence &nodeIncidence);
+
+        //! Destructor.
+        ~RNodeIncidence();
+
+        //! Assignment operator.
+        RNodeIncidence &operator =(const RNodeIncidence &nodeIncidence);
+
+        //! Build incidence for given number of nodes and elements.
+        void build(uint nNodes, const std::vector<RElement> &elements);
+
+        //! Clear incidence.
+        void clear(void);
+
+        //! Return true if incidence was built.
+        bool isBuilt(void) const;
+
+        //! Return number of elements containing given node.
+        uint getNElements(uint nodeID) const;
+
+        //! Return sorted IDs of elements containing given node.
+        std::vector<uint> getElementIDs(uint nodeID) const;
+
+        //! Patch incidence after element was appended.
+        void addElement(const RElement &element);
+
+        //! Patch incidence after element was replaced.
+        void setElement(uint elementID, const RElement &oldElement, const RElement &newElement);
+
+        //! Patch incidence after element was removed.
+        //! All element IDs greater than elementID are decreased by one.
+        void removeElement(uint elementID, const RElement &element);
+
+        //! Patch incidence after node was appended.
+        void addNode(void);
+
+        //! Patch incidence after node was removed.
+        //! If removed node is still used by some element incidence is cleared.
+        void removeNode(uint nodeID);
+
+};
+
+#endif /* RML_NODE_INCIDENCE_H */
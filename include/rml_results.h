@@ -1,9 +1,14 @@
 #ifndef RML_RESULTS_H
 #define RML_RESULTS_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 
+#include <QDateTime>
+
+#include <rbl_version.h>
+
 #include "rml_variable.h"
 
 //! Results class.
@@ -15,6 +20,12 @@ class RResults
         //! Internal initialization function.
         void _init(const RResults *results = nullptr);
 
+        //! Load deferred variable from file.
+        void loadVariable(unsigned int position) const;
+
+        //! Update number of deferred variables after deferred offsets were modified.
+        void updateNDeferred();
+
     protected:
 
         //! Number of nodes.
@@ -22,7 +33,27 @@ class RResults
         //! Number of elements.
         unsigned int nelements;
         //! Variables.
-        std::vector<RVariable> variables;
+        //! Deferred variables hold only header with empty value vectors until they are loaded.
+        mutable std::vector<RVariable> variables;
+        //! File from which deferred variables are loaded.
+        QString deferredFileName;
+        //! Version of file from which deferred variables are loaded.
+        RVersion deferredFileVersion;
+        //! Size of file from which deferred variables are loaded.
+        qint64 deferredFileSize;
+        //! Modification time of file from which deferred variables are loaded.
+        QDateTime deferredFileModified;
+        //! Position of each deferred variable in file, negative for loaded variables.
+        //! Empty if no variable is deferred.
+        //! Accessed under lock while any variable is deferred.
+        mutable std::vector<qint64> deferredOffsets;
+        //! Number of deferred variables, published with release/acquire ordering.
+        mutable std::atomic<uint> nDeferred;
+
+        //! Mark variables as deferred.
+        //! Variable at given position is loaded from file offset on first access.
+        //! Size and modification time of the file are recorded and loading fails if the file was changed.
+        void setDeferredVariables(const QString &fileName, const RVersion &fileVersion, const std::vector<qint64> &offsets);
 
     public:
 
@@ -53,13 +84,22 @@ class RResults
         //! Set number of node variables.
         void setNVariables(unsigned int nvariables);
 
+        //! Return true if variable values are loaded.
+        bool isVariableLoaded(unsigned int position) const;
+
+        //! Load all deferred variables.
+        void loadVariables() const;
+
         //! Return const reference to variable.
+        //! Deferred variable is loaded on first access.
         const RVariable &getVariable(unsigned int position) const;
 
         //! Return reference to variable.
+        //! Deferred variable is loaded on first access.
         RVariable &getVariable(unsigned int position);
 
         //! Find variable.
+        //! Deferred variables are not loaded.
         //! If such variable type can not be found RConstants::eod is returned.
         unsigned int findVariable(RVariableType variableType) const;
 
@@ -84,6 +124,9 @@ class RResults
         //! Remove all variables.
         void removeAllVariables();
 
+        //! Set compression of all variables used when results are written to binary file.
+        void setVariableCompression(RVariableCompressionType compressionType, double compressionTolerance = 0.0);
+
         //! Return number of nodes.
         unsigned int getNNodes() const;
 
@@ -96,6 +139,10 @@ class RResults
         //! Remove node from results at give position.
         void removeNode(unsigned int position);
 
+        //! Remove nodes from results at give positions.
+        //! If nodeBook[i] == RConstants::eod then node will be removed.
+        void removeNodes(const std::vector<uint>&nodeBook);
+
         //! Return number of elements.
         unsigned int getNElements() const;
 
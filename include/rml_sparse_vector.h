@@ -151,6 +151,19 @@ class RSparseVector
             }
         }
 
+        //! Append value with index larger than index of last value.
+        //! Allows building vector from presorted indexes without searching and sorting.
+        //! If index is not larger than last index nothing is appended and false is returned.
+        bool appendValue(uint index, T value)
+        {
+            if (!this->data.empty() && this->data.back().index >= index)
+            {
+                return false;
+            }
+            this->data.push_back(RSparseVectorItem<T>(index,value));
+            return true;
+        }
+
         //! Return real sized vector of values.
         //! nElements difines minimum size of the vector.
         std::vector<T> getValues(uint nElements) const
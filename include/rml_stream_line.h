@@ -6,6 +6,21 @@
 #include "rml_variable.h"
 #include "rml_interpolated_entity.h"
 
+//! Stream line integrator.
+typedef enum _RStreamLineIntegrator
+{
+    //! Walk from element to element along straight segments given by value at element entry point.
+    R_STREAM_LINE_INTEGRATOR_ELEMENT_WALK = 0,
+    //! Fourth order Runge-Kutta with step size control (volume elements only).
+    R_STREAM_LINE_INTEGRATOR_RUNGE_KUTTA_4,
+    R_STREAM_LINE_INTEGRATOR_N_TYPES
+} RStreamLineIntegrator;
+
+#define R_STREAM_LINE_INTEGRATOR_IS_VALID(_integrator) \
+( \
+    _integrator >= R_STREAM_LINE_INTEGRATOR_ELEMENT_WALK && _integrator < R_STREAM_LINE_INTEGRATOR_N_TYPES \
+)
+
 class RStreamLine : public RInterpolatedEntity
 {
 
@@ -13,6 +28,10 @@ class RStreamLine : public RInterpolatedEntity
 
         //! Default entity name.
         const static QString defaultName;
+        //! Default relative tolerance of integration step.
+        const static double defaultTolerance;
+        //! Maximum number of integration steps.
+        const static uint maxSteps;
 
     protected:
 
@@ -20,6 +39,10 @@ class RStreamLine : public RInterpolatedEntity
         RVariableType variableType;
         //! Start position.
         RR3Vector position;
+        //! Integrator.
+        RStreamLineIntegrator integrator;
+        //! Relative tolerance of integration step.
+        double tolerance;
 
     private:
 
@@ -52,6 +75,30 @@ class RStreamLine : public RInterpolatedEntity
         //! Set position vector.
         void setPosition ( const RR3Vector &position );
 
+        //! Return integrator.
+        RStreamLineIntegrator getIntegrator ( void ) const;
+
+        //! Set integrator.
+        void setIntegrator ( RStreamLineIntegrator integrator );
+
+        //! Return relative tolerance of integration step.
+        double getTolerance ( void ) const;
+
+        //! Set relative tolerance of integration step.
+        void setTolerance ( double tolerance );
+
+        //! Return given number of start positions evenly distributed along line (rake).
+        static std::vector<RR3Vector> findRakePositions ( const RR3Vector &start,
+                                                          const RR3Vector &end,
+                                                          uint nPositions );
+
+        //! Return start positions in regular grid given by origin and two edge vectors.
+        static std::vector<RR3Vector> findGridPositions ( const RR3Vector &origin,
+                                                          const RR3Vector &edge1,
+                                                          const RR3Vector &edge2,
+                                                          uint nPositions1,
+                                                          uint nPositions2 );
+
         //! Allow RFileIO to access private members.
         friend class RFileIO;
 
@@ -1,9 +1,12 @@
 #ifndef RML_VARIABLE_H
 #define RML_VARIABLE_H
 
+#include <atomic>
+
 #include <rbl_value_vector.h>
 
 #include "rml_problem_type.h"
+#include "rml_variable_compression.h"
 #include "rml_variable_data.h"
 
 #define R_VARIABLE_TYPE_IS_VALID(_type) \
@@ -154,15 +157,37 @@ typedef enum _RVariableApplyType
 typedef int RVariableApplyTypeMask;
 
 
+//! Variable value statistics.
+typedef struct _RVariableStatistics
+{
+    //! Minimum value.
+    double minValue;
+    //! Maximum value.
+    double maxValue;
+    //! Mean value.
+    double meanValue;
+} RVariableStatistics;
+
 //! Variable class.
 class RVariable
 {
 
+    public:
+
+        //! Number of values processed in one block when statistics or magnitudes are computed.
+        static const uint blockSize;
+
     private:
 
         //! Internal initialization function
         void _init ( const RVariable *variable = nullptr );
 
+        //! Compute value statistics if they are not valid.
+        void findStatistics ( void ) const;
+
+        //! Compute magnitude of value vector at given position.
+        double findMagnitude ( unsigned int valpos ) const;
+
     protected:
 
         //! Variable type.
@@ -177,6 +202,19 @@ class RVariable
         std::vector<RValueVector> values;
         //! Variable data.
         RVariableData variableData;
+        //! Compression type used when values are written to binary file.
+        RVariableCompressionType compressionType;
+        //! Relative tolerance of lossy compression, zero for lossless compression.
+        double compressionTolerance;
+        //! Statistics of each value vector followed by statistics of magnitude.
+        //! Statistics are computed on first request.
+        mutable std::vector<RVariableStatistics> statistics;
+        //! Statistics are valid, published with release/acquire ordering.
+        mutable std::atomic<bool> statisticsValid;
+        //! Materialized magnitude values.
+        mutable RRVector magnitudes;
+        //! Magnitude values are valid, published with release/acquire ordering.
+        mutable std::atomic<bool> magnitudesValid;
 
     public:
 
@@ -260,6 +298,22 @@ class RVariable
         //! Return maximum value for a given vector.
         double getMaxValue ( unsigned int vecpos ) const;
 
+        //! Return mean value.
+        //! If variable is vector type mean magnitude will be returned.
+        double getMeanValue ( void ) const;
+
+        //! Return mean value for a given vector.
+        double getMeanValue ( unsigned int vecpos ) const;
+
+        //! Return magnitude values.
+        //! Magnitudes are computed on first request and kept until values are modified,
+        //! meanwhile getValue(valpos) returns magnitude from this array.
+        const RRVector & getMagnitudes ( void ) const;
+
+        //! Invalidate statistics and magnitudes.
+        //! Must be called if values were modified through reference obtained before statistics were requested.
+        void invalidateStatistics ( void );
+
         //! Set value at given position.
         void setValue ( unsigned int vecpos,
                         unsigned int valpos,
@@ -284,13 +338,25 @@ class RVariable
         //! Set variable data.
         void setVariableData ( RVariableData &variableData );
 
+        //! Return compression type used when values are written to binary file.
+        RVariableCompressionType getCompressionType ( void ) const;
+
+        //! Return relative tolerance of lossy compression.
+        double getCompressionTolerance ( void ) const;
+
+        //! Set compression used when values are written to binary file.
+        //! If tolerance is positive values are truncated so that their relative error is smaller than tolerance.
+        void setCompression ( RVariableCompressionType compressionType,
+                              double                   compressionTolerance = 0.0 );
+
         //! Assignment operator.
         RVariable & operator = ( const RVariable &variable );
 
         //! Return value at given position.
         const RValueVector & operator [] ( unsigned int vecpos ) const;
 
-        //! Set value at given position.
+        //! Return reference to value vector at given position.
+        //! Statistics and magnitudes are not invalidated, invalidateStatistics() must be called after values were modified.
         RValueVector & operator [] ( unsigned int vecpos );
 
         //! Return variable type for given variable ID.
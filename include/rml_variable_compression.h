@@ -0,0 +1,53 @@
+#ifndef RML_VARIABLE_COMPRESSION_H
+#define RML_VARIABLE_COMPRESSION_H
+
+#include <QByteArray>
+
+//! Variable values compression type.
+typedef enum _RVariableCompressionType
+{
+    //! Values are stored as plain block of doubles.
+    R_VARIABLE_COMPRESSION_NONE = 0,
+    //! Bytes of values are shuffled in to byte planes and compressed with zlib.
+    R_VARIABLE_COMPRESSION_SHUFFLE_ZLIB,
+    R_VARIABLE_COMPRESSION_N_TYPES
+} RVariableCompressionType;
+
+#define R_VARIABLE_COMPRESSION_TYPE_IS_VALID(_type) \
+( \
+    _type >= R_VARIABLE_COMPRESSION_NONE && _type < R_VARIABLE_COMPRESSION_N_TYPES \
+)
+
+//! Codec for variable values stored in binary files.
+//! Values are split in to byte planes (all first bytes, all second bytes, ...)
+//! which makes slowly changing exponents and high mantissa bytes highly compressible.
+//! If tolerance is positive, low mantissa bits are cleared before compression
+//! so that relative error of each value is smaller than tolerance.
+class RVariableCompression
+{
+
+    public:
+
+        //! Compression level passed to zlib.
+        static const int compressionLevel;
+
+    private:
+
+        //! Private constructor.
+        explicit RVariableCompression() {}
+
+    public:
+
+        //! Return number of mantissa bits which must be kept to satisfy given relative tolerance.
+        static int findMantissaBits(double tolerance);
+
+        //! Compress n values.
+        static QByteArray compress(const double *values, qsizetype n, double tolerance = 0.0);
+
+        //! Decompress n values.
+        //! Throws RError if data can not be decompressed to exactly n values.
+        static void decompress(const QByteArray &data, double *values, qsizetype n);
+
+};
+
+#endif // RML_VARIABLE_COMPRESSION_H
@@ -0,0 +1,142 @@
+#include <charconv>
+
+#include "rml_ascii_parser.h"
+
+const uint RAsciiParser::minLines = 10000;
+const uint RAsciiParser::chunkSize = 16384;
+
+qint64 RAsciiParser::findLineChunks(const char *data, qint64 size, qint64 offset, uint nLines, std::vector<qint64> &chunkOffsets)
+{
+    chunkOffsets.clear();
+
+    uint lineID = 0;
+    qint64 position = offset;
+    while (lineID < nLines && position < size)
+    {
+        const char *lineBegin = data + position;
+        const char *lineEnd = (const char*)std::memchr(lineBegin,'\n',size_t(size - position));
+        if (!lineEnd)
+        {
+            lineEnd = data + size;
+        }
+        if (!RAsciiParser::isBlank(lineBegin,lineEnd))
+        {
+            if (lineID % RAsciiParser::chunkSize == 0)
+            {
+                chunkOffsets.push_back(position);
+            }
+            lineID++;
+        }
+        position = qint64(lineEnd - data) + 1;
+    }
+
+    if (lineID < nLines)
+    {
+        return -1;
+    }
+
+    position = std::min(position,size);
+    chunkOffsets.push_back(position);
+
+    return position;
+}
+
+bool RAsciiParser::isBlank(const char *cursor, const char *end)
+{
+    while (cursor < end)
+    {
+        if (!RAsciiParser::isSpace(*cursor))
+        {
+            return false;
+        }
+        cursor++;
+    }
+    return true;
+}
+
+bool RAsciiParser::findToken(const char *&cursor, const char *end, const char *&tokenBegin, const char *&tokenEnd)
+{
+    while (cursor < end && RAsciiParser::isSpace(*cursor))
+    {
+        cursor++;
+    }
+    if (cursor >= end)
+    {
+        return false;
+    }
+    tokenBegin = cursor;
+    while (cursor < end && !RAsciiParser::isSpace(*cursor))
+    {
+        cursor++;
+    }
+    tokenEnd = cursor;
+
+    return true;
+}
+
+bool RAsciiParser::parseDouble(const char *&cursor, const char *end, double &value)
+{
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
+    if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd))
+    {
+        return false;
+    }
+    if (*tokenBegin == '+')
+    {
+        tokenBegin++;
+        if (tokenBegin < tokenEnd && *tokenBegin == '-')
+        {
+            return false;
+        }
+    }
+    std::from_chars_result result = std::from_chars(tokenBegin,tokenEnd,value);
+    return (result.ec == std::errc() && result.ptr == tokenEnd);
+}
+
+bool RAsciiParser::parseInt(const char *&cursor, const char *end, int &value)
+{
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
+    if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd))
+    {
+        return false;
+    }
+    if (*tokenBegin == '+')
+    {
+        tokenBegin++;
+        if (tokenBegin < tokenEnd && *tokenBegin == '-')
+        {
+            return false;
+        }
+    }
+    // Text stream would interpret leading zero as octal or hexadecimal prefix.
+    const char *digitsBegin = (tokenBegin < tokenEnd && *tokenBegin == '-') ? tokenBegin + 1 : tokenBegin;
+    if (tokenEnd - digitsBegin > 1 && *digitsBegin == '0')
+    {
+        return false;
+    }
+    std::from_chars_result result = std::from_chars(tokenBegin,tokenEnd,value);
+    return (result.ec == std::errc() && result.ptr == tokenEnd);
+}
+
+bool RAsciiParser::parseUInt(const char *&cursor, const char *end, uint &value)
+{
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
+    if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd))
+    {
+        return false;
+    }
+    if (*tokenBegin == '+')
+    {
+        tokenBegin++;
+    }
+    // Text stream would interpret leading zero as octal or hexadecimal prefix.
+    if (tokenEnd - tokenBegin > 1 && *tokenBegin == '0')
+    {
+        return false;
+    }
+    std::from_chars_result result = std::from_chars(tokenBegin,tokenEnd,value);
+    return (result.ec == std::errc() && result.ptr == tokenEnd);
+}
@@ -178,6 +178,8 @@ static const RElementDesc elementDesc [] =
 
 
 RElement::RElement (RElementType type)
+    : type (R_ELEMENT_NONE)
+    , nNodes (0)
 {
     this->setType (type);
     this->_init ();
@@ -185,6 +187,8 @@ RElement::RElement (RElementType type)
 
 
 RElement::RElement (const RElement &element)
+    : type (R_ELEMENT_NONE)
+    , nNodes (0)
 {
     this->_init (&element);
 } /* RElement::RElement */
@@ -221,55 +225,18 @@ bool RElement::operator ==(const RElement &element) const
     {
         return false;
     }
-    for (uint i=0;i<this->nodeIDs.size();i++)
-    {
-        bool nodeFound = false;
-        for (uint j=0;j<element.nodeIDs.size();j++)
-        {
-            if (this->nodeIDs[i] == element.nodeIDs[j])
-            {
-                nodeFound = true;
-                break;
-            }
-        }
-        if (!nodeFound)
-        {
-            return false;
-        }
-    }
-    return true;
+    RElementKey key1, key2;
+    this->findKey(key1);
+    element.findKey(key2);
+    return (RElement::compareKeys(key1,key2) == 0);
 } /* RElement::operator == */
 
 bool RElement::operator <(const RElement &element) const
 {
-    if (this->type < element.type)
-    {
-        return true;
-    }
-    else if (this->type > element.type)
-    {
-        return false;
-    }
-
-    std::vector<uint> n1Nodes(this->nodeIDs);
-    std::vector<uint> n2Nodes(element.nodeIDs);
-
-    std::sort(n1Nodes.begin(),n1Nodes.end());
-    std::sort(n2Nodes.begin(),n2Nodes.end());
-
-    for (uint i=0;i<n1Nodes.size();i++)
-    {
-        if (n1Nodes[i] < n2Nodes[i])
-        {
-            return true;
-        }
-        else if (n1Nodes[i] > n2Nodes[i])
-        {
-            return false;
-        }
-    }
-
-    return false;
+    RElementKey key1, key2;
+    this->findKey(key1);
+    element.findKey(key2);
+    return (RElement::compareKeys(key1,key2) < 0);
 } /* RElement::operator < */
 
 
@@ -284,19 +251,26 @@ void RElement::setType (RElementType type)
     R_ERROR_ASSERT (R_ELEMENT_TYPE_IS_VALID (type));
 
     this->type = type;
-    this->nodeIDs.resize (RElement::getNNodes(type));
+
+    // Same as resizing vector, new node IDs are set to zero.
+    unsigned int nNodes = RElement::getNNodes(type);
+    for (unsigned int i=this->nNodes;i<nNodes;i++)
+    {
+        this->nodeIDs[i] = 0;
+    }
+    this->nNodes = nNodes;
 } /* RElement::setType */
 
 
 unsigned int RElement::size (void) const
 {
-    return static_cast<unsigned int>(this->nodeIDs.size());
+    return this->nNodes;
 } /* RElement::size */
 
 
 unsigned int RElement::getNodeId (unsigned int position) const
 {
-    R_ERROR_ASSERT (position < this->nodeIDs.size());
+    R_ERROR_ASSERT (position < this->nNodes);
 
     return this->nodeIDs[position];
 } /* RElement::getNodeId */
@@ -305,15 +279,15 @@ unsigned int RElement::getNodeId (unsigned int position) const
 void RElement::setNodeId (unsigned int position,
                             unsigned int nodeID)
 {
-    R_ERROR_ASSERT (position < this->nodeIDs.size());
+    R_ERROR_ASSERT (position < this->nNodes);
     this->nodeIDs[position] = nodeID;
 } /* RElement::setNodeId */
 
 
 void RElement::swapNodeIds(unsigned int position1, unsigned int position2)
 {
-    R_ERROR_ASSERT (position1 < this->nodeIDs.size());
-    R_ERROR_ASSERT (position2 < this->nodeIDs.size());
+    R_ERROR_ASSERT (position1 < this->nNodes);
+    R_ERROR_ASSERT (position2 < this->nNodes);
     std::swap(this->nodeIDs[position1],this->nodeIDs[position2]);
 } /* RElement::swapNodeIds */
 
@@ -348,6 +322,18 @@ bool RElement::hasDuplicateNodes(void) const
 } /* RElement::hasDuplicateNodes */
 
 
+void RElement::findKey(RElementKey &key) const
+{
+    key.type = this->type;
+    key.nNodes = this->size();
+    for (uint i=0;i<R_ELEMENT_MAX_NODES;i++)
+    {
+        key.nodeIDs[i] = (i < key.nNodes) ? this->nodeIDs[i] : 0;
+    }
+    std::sort(key.nodeIDs,key.nodeIDs+key.nNodes);
+} /* RElement::findKey */
+
+
 bool RElement::swapNormal(void)
 {
     if (!R_ELEMENT_TYPE_IS_SURFACE(this->getType()))
@@ -1094,6 +1080,25 @@ double RElement::interpolate(const std::vector<RNode> &nodes,
                              const RRVector &volumes) const
 {
     RRVector ratios;
+    this->findInterpolationRatios(nodes,interpolatedNode,volumes,ratios);
+
+    double value = 0.0;
+
+    for (unsigned int i=0;i<ratios.size();i++)
+    {
+        value += ratios[i] * nodeValues[i];
+    }
+
+    return value;
+} /* RElement::interpolate */
+
+
+void RElement::findInterpolationRatios(const std::vector<RNode> &nodes,
+                                       const RNode &interpolatedNode,
+                                       const RRVector &volumes,
+                                       RRVector &ratios) const
+{
+    ratios.resize(0);
 
     switch (this->getType())
     {
@@ -1167,16 +1172,7 @@ double RElement::interpolate(const std::vector<RNode> &nodes,
             break;
         }
     }
-
-    double value = 0.0;
-
-    for (unsigned int i=0;i<ratios.size();i++)
-    {
-        value += ratios[i] * nodeValues[i];
-    }
-
-    return value;
-} /* RElement::interpolate */
+} /* RElement::findInterpolationRatios */
 
 
 RRMatrix RElement::findTransformationMatrix(const std::vector<RNode> &nodes, RRMatrix &R, RRVector &t) const
@@ -1606,27 +1602,8 @@ bool RElement::isNeighbor(const RElement &rElement) const
         return RConstants::eod;
     }
 
-    uint nNodesPerSide = 0;
+    uint nNodesPerSide = RElement::getNSideNodes(this->getType());
 
-    if (R_ELEMENT_TYPE_IS_LINE(this->getType()))
-    {
-        nNodesPerSide = 1;
-    }
-    else if (R_ELEMENT_TYPE_IS_SURFACE(this->getType()))
-    {
-        nNodesPerSide = 2;
-    }
-    else if (R_ELEMENT_TYPE_IS_VOLUME(this->getType()))
-    {
-        if (this->getType() == R_ELEMENT_TETRA1)
-        {
-            nNodesPerSide = 3;
-        }
-        if (this->getType() == R_ELEMENT_HEXA1)
-        {
-            nNodesPerSide = 4;
-        }
-    }
     if (nNodesPerSide == 0)
     {
         return false;
@@ -1786,14 +1763,12 @@ bool RElement::mergeNodes(uint nodeId1, uint nodeId2, bool allowDowngrade)
         case R_ELEMENT_TRUSS1:
         {
             this->setType(R_ELEMENT_POINT);
-            this->nodeIDs.resize(1);
             this->setNodeId(0,nids[0]);
             return true;
         }
         case R_ELEMENT_TRI1:
         {
             this->setType(R_ELEMENT_TRUSS1);
-            this->nodeIDs.resize(2);
             this->setNodeId(0,nids[0]);
             this->setNodeId(1,nids[1]);
             return true;
@@ -1801,7 +1776,6 @@ bool RElement::mergeNodes(uint nodeId1, uint nodeId2, bool allowDowngrade)
         case R_ELEMENT_QUAD1:
         {
             this->setType(R_ELEMENT_TRI1);
-            this->nodeIDs.resize(3);
             this->setNodeId(0,nids[0]);
             this->setNodeId(1,nids[1]);
             this->setNodeId(2,nids[2]);
@@ -1810,7 +1784,6 @@ bool RElement::mergeNodes(uint nodeId1, uint nodeId2, bool allowDowngrade)
         case R_ELEMENT_TETRA1:
         {
             this->setType(R_ELEMENT_TRI1);
-            this->nodeIDs.resize(3);
             this->setNodeId(0,nids[0]);
             this->setNodeId(1,nids[1]);
             this->setNodeId(2,nids[2]);
@@ -2194,6 +2167,27 @@ unsigned int RElement::getNNodes(RElementType type)
 } /* RElement::getNNodes */
 
 
+int RElement::compareKeys(const RElementKey &key1, const RElementKey &key2)
+{
+    if (key1.type != key2.type)
+    {
+        return (key1.type < key2.type) ? -1 : 1;
+    }
+    if (key1.nNodes != key2.nNodes)
+    {
+        return (key1.nNodes < key2.nNodes) ? -1 : 1;
+    }
+    for (uint i=0;i<key1.nNodes;i++)
+    {
+        if (key1.nodeIDs[i] != key2.nodeIDs[i])
+        {
+            return (key1.nodeIDs[i] < key2.nodeIDs[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+} /* RElement::compareKeys */
+
+
 unsigned int RElement::getNNeighbors(RElementType type)
 {
     R_ERROR_ASSERT (R_ELEMENT_TYPE_IS_VALID(type));
@@ -2202,6 +2196,28 @@ unsigned int RElement::getNNeighbors(RElementType type)
 } /* RElement::getNNeighbors */
 
 
+unsigned int RElement::getNSideNodes(RElementType type)
+{
+    if (R_ELEMENT_TYPE_IS_LINE(type))
+    {
+        return 1;
+    }
+    else if (R_ELEMENT_TYPE_IS_SURFACE(type))
+    {
+        return 2;
+    }
+    else if (type == R_ELEMENT_TETRA1)
+    {
+        return 3;
+    }
+    else if (type == R_ELEMENT_HEXA1)
+    {
+        return 4;
+    }
+    return 0;
+} /* RElement::getNSideNodes */
+
+
 std::vector<RElementShapeFunction> RElement::generateShapeFunctionValues(RElementType type)
 {
     R_ERROR_ASSERT (R_ELEMENT_TYPE_IS_VALID(type));
@@ -0,0 +1,529 @@
+#include <algorithm>
+#include <cmath>
+
+#include "rml_element_tree.h"
+
+const uint RElementTree::leafSize = 4;
+
+void RElementTree::_init(const RElementTree *pElementTree)
+{
+    if (pElementTree)
+    {
+        this->treeNodes = pElementTree->treeNodes;
+        this->elementIDs = pElementTree->elementIDs;
+        this->elementBoxes = pElementTree->elementBoxes;
+        this->built.store(pElementTree->built.load(std::memory_order_acquire),std::memory_order_release);
+    }
+}
+
+RElementTree::RElementTree()
+    : built(false)
+{
+    this->_init();
+}
+
+RElementTree::RElementTree(const RElementTree &elementTree)
+{
+    this->_init(&elementTree);
+}
+
+RElementTree::~RElementTree()
+{
+
+}
+
+RElementTree &RElementTree::operator =(const RElementTree &elementTree)
+{
+    this->_init(&elementTree);
+    return (*this);
+}
+
+void RElementTree::build(const std::vector<RNode> &nodes, const std::vector<RElement> &elements)
+{
+    std::vector<uint> elementIDs;
+    elementIDs.resize(elements.size());
+    for (uint i=0;i<elements.size();i++)
+    {
+        elementIDs[i] = i;
+    }
+    this->build(nodes,elements,elementIDs);
+}
+
+void RElementTree::build(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const std::vector<uint> &elementIDs)
+{
+    this->clear();
+
+    std::vector<uint> validIDs;
+    validIDs.reserve(elementIDs.size());
+    for (uint i=0;i<elementIDs.size();i++)
+    {
+        if (elements[elementIDs[i]].size() > 0)
+        {
+            validIDs.push_back(elementIDs[i]);
+        }
+    }
+
+    uint nElements = uint(validIDs.size());
+
+    std::vector<RElementTreeBox> boxes(nElements);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElements);i++)
+    {
+        RElementTree::findElementBox(nodes,elements[validIDs[uint(i)]],boxes[uint(i)]);
+    }
+
+    std::vector<uint> order(nElements);
+    for (uint i=0;i<nElements;i++)
+    {
+        order[i] = i;
+    }
+
+    if (nElements > 0)
+    {
+        this->treeNodes.reserve(2 * (nElements / RElementTree::leafSize + 1));
+        this->treeNodes.push_back(RElementTreeNode());
+        this->buildNode(0,0,nElements,boxes,order);
+    }
+
+    this->elementIDs.resize(nElements);
+    this->elementBoxes.resize(nElements);
+    for (uint i=0;i<nElements;i++)
+    {
+        this->elementIDs[i] = validIDs[order[i]];
+        this->elementBoxes[i] = boxes[order[i]];
+    }
+
+    this->built.store(true,std::memory_order_release);
+}
+
+void RElementTree::buildNode(uint nodeID, uint first, uint last, const std::vector<RElementTreeBox> &boxes, std::vector<uint> &order)
+{
+    RElementTreeBox box = boxes[order[first]];
+    double centerLower[3], centerUpper[3];
+    for (uint k=0;k<3;k++)
+    {
+        centerLower[k] = centerUpper[k] = 0.5 * (box.lower[k] + box.upper[k]);
+    }
+
+    for (uint i=first+1;i<last;i++)
+    {
+        const RElementTreeBox &elementBox = boxes[order[i]];
+        for (uint k=0;k<3;k++)
+        {
+            box.lower[k] = std::min(box.lower[k],elementBox.lower[k]);
+            box.upper[k] = std::max(box.upper[k],elementBox.upper[k]);
+
+            double center = 0.5 * (elementBox.lower[k] + elementBox.upper[k]);
+            centerLower[k] = std::min(centerLower[k],center);
+            centerUpper[k] = std::max(centerUpper[k],center);
+        }
+    }
+
+    this->treeNodes[nodeID].box = box;
+
+    if (last - first <= RElementTree::leafSize)
+    {
+        this->treeNodes[nodeID].first = first;
+        this->treeNodes[nodeID].count = last - first;
+        this->treeNodes[nodeID].child = 0;
+        return;
+    }
+
+    // Split along the longest axis of element centers.
+    uint axis = 0;
+    for (uint k=1;k<3;k++)
+    {
+        if (centerUpper[k] - centerLower[k] > centerUpper[axis] - centerLower[axis])
+        {
+            axis = k;
+        }
+    }
+
+    uint middle = first + (last - first) / 2;
+    std::nth_element(order.begin() + first,
+                     order.begin() + middle,
+                     order.begin() + last,
+                     [&boxes,axis](uint a, uint b)
+    {
+        return (boxes[a].lower[axis] + boxes[a].upper[axis]) < (boxes[b].lower[axis] + boxes[b].upper[axis]);
+    });
+
+    uint child = uint(this->treeNodes.size());
+    this->treeNodes[nodeID].first = 0;
+    this->treeNodes[nodeID].count = 0;
+    this->treeNodes[nodeID].child = child;
+
+    this->treeNodes.push_back(RElementTreeNode());
+    this->treeNodes.push_back(RElementTreeNode());
+
+    this->buildNode(child,first,middle,boxes,order);
+    this->buildNode(child+1,middle,last,boxes,order);
+}
+
+void RElementTree::insert(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const std::vector<uint> &elementIDs)
+{
+    if (this->treeNodes.empty())
+    {
+        this->build(nodes,elements,elementIDs);
+        return;
+    }
+
+    std::vector<uint> validIDs;
+    validIDs.reserve(elementIDs.size());
+    for (uint i=0;i<elementIDs.size();i++)
+    {
+        if (elements[elementIDs[i]].size() > 0)
+        {
+            validIDs.push_back(elementIDs[i]);
+        }
+    }
+
+    uint nElements = uint(validIDs.size());
+    if (nElements == 0)
+    {
+        return;
+    }
+
+    std::vector<RElementTreeBox> boxes(nElements);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElements);i++)
+    {
+        RElementTree::findElementBox(nodes,elements[validIDs[uint(i)]],boxes[uint(i)]);
+    }
+
+    std::vector<uint> order(nElements);
+    for (uint i=0;i<nElements;i++)
+    {
+        order[i] = i;
+    }
+
+    // Move current root to the end and build subtree of new elements right behind it,
+    // both then become children of the new root.
+    uint offset = uint(this->elementIDs.size());
+    uint oldRootID = uint(this->treeNodes.size());
+    uint newRootID = oldRootID + 1;
+
+    this->treeNodes.push_back(this->treeNodes[0]);
+    this->treeNodes.push_back(RElementTreeNode());
+    this->buildNode(newRootID,0,nElements,boxes,order);
+
+    for (uint i=newRootID;i<this->treeNodes.size();i++)
+    {
+        if (this->treeNodes[i].count > 0)
+        {
+            this->treeNodes[i].first += offset;
+        }
+    }
+
+    this->treeNodes[0].box = RElementTree::findUnion(this->treeNodes[oldRootID].box,this->treeNodes[newRootID].box);
+    this->treeNodes[0].first = 0;
+    this->treeNodes[0].count = 0;
+    this->treeNodes[0].child = oldRootID;
+
+    this->elementIDs.resize(offset + nElements);
+    this->elementBoxes.resize(offset + nElements);
+    for (uint i=0;i<nElements;i++)
+    {
+        this->elementIDs[offset + i] = validIDs[order[i]];
+        this->elementBoxes[offset + i] = boxes[order[i]];
+    }
+}
+
+void RElementTree::refit(const std::vector<RNode> &nodes, const std::vector<RElement> &elements)
+{
+    if (this->treeNodes.empty())
+    {
+        return;
+    }
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->elementIDs.size());i++)
+    {
+        const RElement &rElement = elements[this->elementIDs[uint(i)]];
+        if (rElement.size() > 0)
+        {
+            RElementTree::findElementBox(nodes,rElement,this->elementBoxes[uint(i)]);
+        }
+    }
+
+    this->refitNode(0);
+}
+
+void RElementTree::clear(void)
+{
+    this->treeNodes.clear();
+    this->elementIDs.clear();
+    this->elementBoxes.clear();
+    this->built.store(false,std::memory_order_release);
+}
+
+bool RElementTree::isBuilt(void) const
+{
+    return this->built.load(std::memory_order_acquire);
+}
+
+void RElementTree::refitNode(uint nodeID)
+{
+    uint first = this->treeNodes[nodeID].first;
+    uint count = this->treeNodes[nodeID].count;
+    uint child = this->treeNodes[nodeID].child;
+
+    RElementTreeBox box;
+    if (count == 0)
+    {
+        this->refitNode(child);
+        this->refitNode(child + 1);
+        box = RElementTree::findUnion(this->treeNodes[child].box,this->treeNodes[child + 1].box);
+    }
+    else
+    {
+        box = this->elementBoxes[first];
+        for (uint i=first+1;i<first+count;i++)
+        {
+            box = RElementTree::findUnion(box,this->elementBoxes[i]);
+        }
+    }
+    this->treeNodes[nodeID].box = box;
+}
+
+void RElementTree::findPositions(const RElementTreeBox &box, std::vector<uint> &positions, double tolerance) const
+{
+    positions.clear();
+
+    if (this->treeNodes.empty())
+    {
+        return;
+    }
+
+    std::vector<uint> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const RElementTreeNode &treeNode = this->treeNodes[stack.back()];
+        stack.pop_back();
+
+        if (!RElementTree::areIntersecting(box,treeNode.box,tolerance))
+        {
+            continue;
+        }
+
+        if (treeNode.count == 0)
+        {
+            stack.push_back(treeNode.child);
+            stack.push_back(treeNode.child + 1);
+            continue;
+        }
+
+        for (uint i=treeNode.first;i<treeNode.first+treeNode.count;i++)
+        {
+            if (RElementTree::areIntersecting(box,this->elementBoxes[i],tolerance))
+            {
+                positions.push_back(i);
+            }
+        }
+    }
+}
+
+void RElementTree::findPositions(const RPlane &plane, std::vector<uint> &positions, double tolerance) const
+{
+    positions.clear();
+
+    if (this->treeNodes.empty())
+    {
+        return;
+    }
+
+    RR3Vector normal(plane.getNormal());
+    if (normal.length() == 0.0)
+    {
+        return;
+    }
+    normal.normalize();
+    const RR3Vector &position = plane.getPosition();
+
+    std::vector<uint> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const RElementTreeNode &treeNode = this->treeNodes[stack.back()];
+        stack.pop_back();
+
+        if (!RElementTree::isIntersecting(position,normal,treeNode.box,tolerance))
+        {
+            continue;
+        }
+
+        if (treeNode.count == 0)
+        {
+            stack.push_back(treeNode.child);
+            stack.push_back(treeNode.child + 1);
+            continue;
+        }
+
+        for (uint i=treeNode.first;i<treeNode.first+treeNode.count;i++)
+        {
+            if (RElementTree::isIntersecting(position,normal,this->elementBoxes[i],tolerance))
+            {
+                positions.push_back(i);
+            }
+        }
+    }
+}
+
+void RElementTree::findElementIDs(const RNode &node, std::vector<uint> &candidateIDs, double tolerance) const
+{
+    RElementTreeBox box;
+    box.lower[0] = box.upper[0] = node.getX();
+    box.lower[1] = box.upper[1] = node.getY();
+    box.lower[2] = box.upper[2] = node.getZ();
+
+    this->findElementIDs(box,candidateIDs,tolerance);
+}
+
+void RElementTree::findElementIDs(const RElementTreeBox &box, std::vector<uint> &candidateIDs, double tolerance) const
+{
+    this->findPositions(box,candidateIDs,tolerance);
+
+    for (uint i=0;i<candidateIDs.size();i++)
+    {
+        candidateIDs[i] = this->elementIDs[candidateIDs[i]];
+    }
+
+    std::sort(candidateIDs.begin(),candidateIDs.end());
+}
+
+void RElementTree::findElementIDs(const RPlane &plane, std::vector<uint> &candidateIDs, double tolerance) const
+{
+    this->findPositions(plane,candidateIDs,tolerance);
+
+    for (uint i=0;i<candidateIDs.size();i++)
+    {
+        candidateIDs[i] = this->elementIDs[candidateIDs[i]];
+    }
+
+    std::sort(candidateIDs.begin(),candidateIDs.end());
+}
+
+void RElementTree::findElementPairs(std::vector< std::pair<uint,uint> > &elementPairs, double tolerance) const
+{
+    uint nElements = uint(this->elementIDs.size());
+
+    // Collect candidates of each element separately so that result does not depend on thread scheduling.
+    std::vector< std::vector<uint> > pairedIDs(nElements);
+
+#pragma omp parallel for schedule(dynamic,256) default(shared)
+    for (int64_t i=0;i<int64_t(nElements);i++)
+    {
+        uint elementID = this->elementIDs[uint(i)];
+        std::vector<uint> positions;
+        this->findPositions(this->elementBoxes[uint(i)],positions,tolerance);
+        for (uint j=0;j<positions.size();j++)
+        {
+            if (this->elementIDs[positions[j]] > elementID)
+            {
+                pairedIDs[uint(i)].push_back(this->elementIDs[positions[j]]);
+            }
+        }
+    }
+
+    size_t nPairs = 0;
+    for (uint i=0;i<nElements;i++)
+    {
+        nPairs += pairedIDs[i].size();
+    }
+
+    elementPairs.clear();
+    elementPairs.reserve(nPairs);
+    for (uint i=0;i<nElements;i++)
+    {
+        for (uint j=0;j<pairedIDs[i].size();j++)
+        {
+            elementPairs.push_back(std::pair<uint,uint>(this->elementIDs[i],pairedIDs[i][j]));
+        }
+        std::vector<uint>().swap(pairedIDs[i]);
+    }
+
+    std::sort(elementPairs.begin(),elementPairs.end());
+}
+
+uint RElementTree::findElementID(const std::vector<RNode> &nodes, const std::vector<RElement> &elements, const RNode &node) const
+{
+    std::vector<uint> candidateIDs;
+    this->findElementIDs(node,candidateIDs);
+
+    for (uint i=0;i<candidateIDs.size();i++)
+    {
+        if (elements[candidateIDs[i]].isInside(nodes,node))
+        {
+            return candidateIDs[i];
+        }
+    }
+
+    return RConstants::eod;
+}
+
+void RElementTree::findElementBox(const std::vector<RNode> &nodes, const RElement &element, RElementTreeBox &box)
+{
+    for (uint i=0;i<element.size();i++)
+    {
+        const RNode &rNode = nodes[element.getNodeId(i)];
+        if (i == 0)
+        {
+            box.lower[0] = box.upper[0] = rNode.getX();
+            box.lower[1] = box.upper[1] = rNode.getY();
+            box.lower[2] = box.upper[2] = rNode.getZ();
+        }
+        else
+        {
+            box.lower[0] = std::min(box.lower[0],rNode.getX());
+            box.lower[1] = std::min(box.lower[1],rNode.getY());
+            box.lower[2] = std::min(box.lower[2],rNode.getZ());
+
+            box.upper[0] = std::max(box.upper[0],rNode.getX());
+            box.upper[1] = std::max(box.upper[1],rNode.getY());
+            box.upper[2] = std::max(box.upper[2],rNode.getZ());
+        }
+    }
+}
+
+RElementTreeBox RElementTree::findUnion(const RElementTreeBox &box1, const RElementTreeBox &box2)
+{
+    RElementTreeBox box;
+    for (uint k=0;k<3;k++)
+    {
+        box.lower[k] = std::min(box1.lower[k],box2.lower[k]);
+        box.upper[k] = std::max(box1.upper[k],box2.upper[k]);
+    }
+    return box;
+}
+
+bool RElementTree::areIntersecting(const RElementTreeBox &box1, const RElementTreeBox &box2, double tolerance)
+{
+    for (uint k=0;k<3;k++)
+    {
+        if (box1.upper[k] + tolerance < box2.lower[k] || box2.upper[k] + tolerance < box1.lower[k])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RElementTree::isIntersecting(const RR3Vector &position, const RR3Vector &normal, const RElementTreeBox &box, double tolerance)
+{
+    // Signed distance of box center from plane and half extent of box projected on to plane normal.
+    double distance = 0.0;
+    double extent = 0.0;
+    for (uint k=0;k<3;k++)
+    {
+        distance += normal[k] * (0.5 * (box.lower[k] + box.upper[k]) - position[k]);
+        extent += std::fabs(normal[k]) * 0.5 * (box.upper[k] - box.lower[k]);
+    }
+    return (std::fabs(distance) <= extent + tolerance);
+}
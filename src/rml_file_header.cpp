@@ -8,7 +8,8 @@ static const char* fileTypeDesc [] =
     "Material",
     "ViewFactorMatrix",
     "DisplayProperties",
-    "Link"
+    "Link",
+    "Results"
 };
 
 void RFileHeader::_init(const RFileHeader *pHeader)
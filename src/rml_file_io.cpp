@@ -1,9 +1,55 @@
+#include <type_traits>
+
+#include <QtEndian>
+
 #include <rbl_error.h>
 #include <rbl_logger.h>
 #include <rbl_utils.h>
 
 #include "rml_file_io.h"
+#include "rml_ascii_parser.h"
+
+template <typename T>
+static void readLittleEndianBlock(RFile &inFile, T *values, qsizetype n, const char *typeName)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+    qint64 nBytes = qint64(n) * qint64(sizeof(T));
+    if (inFile.read((char*)values,nBytes) != nBytes || inFile.error() != RFile::NoError)
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read block of %lld %s values.",(long long)n,typeName);
+    }
+    qFromLittleEndian<T>(values,n,values);
+}
+
+template <typename T>
+static void writeLittleEndianBlock(RSaveFile &outFile, const T *values, qsizetype n, const char *typeName)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+    qint64 nBytes = qint64(n) * qint64(sizeof(T));
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    const char *data = (const char*)values;
+#else
+    std::vector<T> buffer(n);
+    qToLittleEndian<T>(values,n,buffer.data());
+    const char *data = (const char*)buffer.data();
+#endif
+    if (outFile.write(data,nBytes) != nBytes || outFile.error() != RFile::NoError)
+    {
+        throw RError(RError::Type::WriteFile,R_ERROR_REF,"Failed to write block of %lld %s values.",(long long)n,typeName);
+    }
+}
+
 
+bool RFileIO::isBlockLayoutVersion(const RVersion &version)
+{
+    return (version > RVersion(1,2,0));
+}
 
 void RFileIO::writeNewLineAscii(RSaveFile &outFile)
 {
@@ -418,6 +464,99 @@ void RFileIO::writeBinary(RSaveFile &outFile, const qsizetype &sValue)
 } /* RFileIO::writeBinary */
 
 
+/*********************************************************************
+ *  std::vector<qsizetype>                                           *
+ *********************************************************************/
+
+
+void RFileIO::readBinary(RFile &inFile, std::vector<qsizetype> &sValues)
+{
+    unsigned int n = 0;
+    RFileIO::readBinary(inFile,n);
+    sValues.resize(n);
+    for (unsigned int i=0;i<n;i++)
+    {
+        RFileIO::readBinary(inFile,sValues[i]);
+    }
+} /* RFileIO::readBinary */
+
+
+void RFileIO::writeBinary(RSaveFile &outFile, const std::vector<qsizetype> &sValues)
+{
+    RFileIO::writeBinary(outFile,uint(sValues.size()));
+    for (unsigned int i=0;i<sValues.size();i++)
+    {
+        RFileIO::writeBinary(outFile,sValues[i]);
+    }
+} /* RFileIO::writeBinary */
+
+
+/*********************************************************************
+ *  QByteArray                                                       *
+ *********************************************************************/
+
+
+void RFileIO::readBinary(RFile &inFile, QByteArray &bValues)
+{
+    qsizetype n = 0;
+    RFileIO::readBinary(inFile,n);
+    if (n < 0 || n > inFile.size() - inFile.pos())
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid byte array size %lld.",(long long)n);
+    }
+    bValues.resize(n);
+    RFileIO::readBinaryBlock(inFile,bValues.data(),n);
+} /* RFileIO::readBinary */
+
+
+void RFileIO::writeBinary(RSaveFile &outFile, const QByteArray &bValues)
+{
+    RFileIO::writeBinary(outFile,bValues.size());
+    RFileIO::writeBinaryBlock(outFile,bValues.constData(),bValues.size());
+} /* RFileIO::writeBinary */
+
+
+/*********************************************************************
+ *  Binary blocks                                                    *
+ *********************************************************************/
+
+
+void RFileIO::readBinaryBlock(RFile &inFile, char *cValues, qsizetype n)
+{
+    readLittleEndianBlock(inFile,cValues,n,"char");
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::readBinaryBlock(RFile &inFile, unsigned int *uValues, qsizetype n)
+{
+    readLittleEndianBlock(inFile,uValues,n,"unsigned int");
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::readBinaryBlock(RFile &inFile, double *dValues, qsizetype n)
+{
+    readLittleEndianBlock(inFile,dValues,n,"double");
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const char *cValues, qsizetype n)
+{
+    writeLittleEndianBlock(outFile,cValues,n,"char");
+} /* RFileIO::writeBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const unsigned int *uValues, qsizetype n)
+{
+    writeLittleEndianBlock(outFile,uValues,n,"unsigned int");
+} /* RFileIO::writeBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const double *dValues, qsizetype n)
+{
+    writeLittleEndianBlock(outFile,dValues,n,"double");
+} /* RFileIO::writeBinaryBlock */
+
+
 /*********************************************************************
  *  QUuid                                                            *
  *********************************************************************/
@@ -1010,6 +1149,23 @@ void RFileIO::readAscii(RFile &inFile, RIMatrix &iMatrix, bool readSize)
     {
         nr = iMatrix.getNRows();
     }
+    // Each row is stored on separate line which allows parallel parsing.
+    unsigned int nc = iMatrix.getNColumns();
+    bool parsed = RAsciiParser::parseLines(inFile,nr,[&iMatrix,nc](const char *lineBegin, const char *lineEnd, uint lineID)
+    {
+        for (unsigned int j=0;j<nc;j++)
+        {
+            if (!RAsciiParser::parseInt(lineBegin,lineEnd,iMatrix[lineID][j]))
+            {
+                return false;
+            }
+        }
+        return RAsciiParser::isBlank(lineBegin,lineEnd);
+    });
+    if (parsed)
+    {
+        return;
+    }
     for (unsigned int i=0;i<nr;i++)
     {
         RFileIO::readAscii(inFile,iMatrix[i],false);
@@ -1104,6 +1260,23 @@ void RFileIO::readAscii(RFile &inFile, RRMatrix &rMatrix, bool readSize)
     {
         nr = rMatrix.getNRows();
     }
+    // Each row is stored on separate line which allows parallel parsing.
+    unsigned int nc = rMatrix.getNColumns();
+    bool parsed = RAsciiParser::parseLines(inFile,nr,[&rMatrix,nc](const char *lineBegin, const char *lineEnd, uint lineID)
+    {
+        for (unsigned int j=0;j<nc;j++)
+        {
+            if (!RAsciiParser::parseDouble(lineBegin,lineEnd,rMatrix[lineID][j]))
+            {
+                return false;
+            }
+        }
+        return RAsciiParser::isBlank(lineBegin,lineEnd);
+    });
+    if (parsed)
+    {
+        return;
+    }
     for (unsigned int i=0;i<nr;i++)
     {
         try {
@@ -1265,9 +1438,21 @@ void RFileIO::readBinary(RFile &inFile, RValueVector &valueVector)
     valueVector.setUnits(units);
     valueVector.resize(n);
 
-    for (unsigned int i=0;i<n;i++)
+    if (RFileIO::isBlockLayoutVersion(inFile.getVersion()))
     {
-        RFileIO::readBinary(inFile,valueVector[i]);
+        std::vector<double> values(n);
+        RFileIO::readBinaryBlock(inFile,values.data(),n);
+        for (unsigned int i=0;i<n;i++)
+        {
+            valueVector[i] = values[i];
+        }
+    }
+    else
+    {
+        for (unsigned int i=0;i<n;i++)
+        {
+            RFileIO::readBinary(inFile,valueVector[i]);
+        }
     }
 } /* RFileIO::readBinary */
 
@@ -1311,10 +1496,12 @@ void RFileIO::writeBinary(RSaveFile &outFile, const RValueVector &valueVector)
     RFileIO::writeBinary(outFile,valueVector.getUnits());
     RFileIO::writeBinary(outFile,n);
 
+    std::vector<double> values(n);
     for (unsigned int i=0;i<n;i++)
     {
-        RFileIO::writeBinary(outFile,valueVector[i]);
+        values[i] = valueVector[i];
     }
+    RFileIO::writeBinaryBlock(outFile,values.data(),n);
 } /* RFileIO::writeBinary */
 
 
@@ -1882,6 +2069,29 @@ void RFileIO::writeBinary(RSaveFile &outFile, const RVariableApplyType &variable
 } /* RFileIO::writeBinary */
 
 
+/*********************************************************************
+ *  RVariableCompressionType                                         *
+ *********************************************************************/
+
+
+void RFileIO::readBinary(RFile &inFile, RVariableCompressionType &compressionType)
+{
+    int iValue = 0;
+    RFileIO::readBinary(inFile,iValue);
+    if (!R_VARIABLE_COMPRESSION_TYPE_IS_VALID(iValue))
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid RVariableCompressionType value %d.",iValue);
+    }
+    compressionType = RVariableCompressionType(iValue);
+} /* RFileIO::readBinary */
+
+
+void RFileIO::writeBinary(RSaveFile &outFile, const RVariableCompressionType &compressionType)
+{
+    RFileIO::writeBinary(outFile,int(compressionType));
+} /* RFileIO::writeBinary */
+
+
 /*********************************************************************
  *  RVariableData                                                    *
  *********************************************************************/
@@ -1962,6 +2172,7 @@ void RFileIO::readAscii(RFile &inFile, RVariable &variable)
         RFileIO::readAscii(inFile,variable.values[i]);
     }
     RFileIO::readAscii(inFile,variable.variableData);
+    variable.invalidateStatistics();
 } /* RFileIO::readAscii */
 
 
@@ -1971,17 +2182,98 @@ void RFileIO::readBinary(RFile &inFile, RVariable &variable)
     RFileIO::readBinary(inFile,variable.applyType);
     RFileIO::readBinary(inFile,variable.name);
     RFileIO::readBinary(inFile,variable.units);
+    variable.compressionType = R_VARIABLE_COMPRESSION_NONE;
+    variable.compressionTolerance = 0.0;
+    if (RFileIO::isBlockLayoutVersion(inFile.getVersion()))
+    {
+        RFileIO::readBinary(inFile,variable.compressionType);
+        RFileIO::readBinary(inFile,variable.compressionTolerance);
+    }
     unsigned int nValues = 0;
     RFileIO::readBinary(inFile,nValues);
     variable.values.resize(nValues);
     for (unsigned int i=0;i<variable.values.size();i++)
     {
-        RFileIO::readBinary(inFile,variable.values[i]);
+        if (variable.compressionType == R_VARIABLE_COMPRESSION_NONE)
+        {
+            RFileIO::readBinary(inFile,variable.values[i]);
+            continue;
+        }
+
+        RValueVector &valueVector = variable.values[i];
+
+        QString name;
+        RFileIO::readBinary(inFile,name);
+        QString units;
+        RFileIO::readBinary(inFile,units);
+        unsigned int n = 0;
+        RFileIO::readBinary(inFile,n);
+
+        valueVector.setName(name);
+        valueVector.setUnits(units);
+        valueVector.resize(n);
+
+        QByteArray data;
+        RFileIO::readBinary(inFile,data);
+        std::vector<double> values(n);
+        RVariableCompression::decompress(data,values.data(),n);
+        for (unsigned int j=0;j<n;j++)
+        {
+            valueVector[j] = values[j];
+        }
     }
     RFileIO::readBinary(inFile,variable.variableData);
+    variable.invalidateStatistics();
 } /* RFileIO::readBinary */
 
 
+void RFileIO::readBinaryHeader(RFile &inFile, RVariable &variable)
+{
+    RFileIO::readBinary(inFile,variable.type);
+    RFileIO::readBinary(inFile,variable.applyType);
+    RFileIO::readBinary(inFile,variable.name);
+    RFileIO::readBinary(inFile,variable.units);
+    variable.compressionType = R_VARIABLE_COMPRESSION_NONE;
+    variable.compressionTolerance = 0.0;
+    if (RFileIO::isBlockLayoutVersion(inFile.getVersion()))
+    {
+        RFileIO::readBinary(inFile,variable.compressionType);
+        RFileIO::readBinary(inFile,variable.compressionTolerance);
+    }
+    unsigned int nValues = 0;
+    RFileIO::readBinary(inFile,nValues);
+    variable.values.resize(nValues);
+    for (unsigned int i=0;i<variable.values.size();i++)
+    {
+        QString name;
+        RFileIO::readBinary(inFile,name);
+        QString units;
+        RFileIO::readBinary(inFile,units);
+        unsigned int n = 0;
+        RFileIO::readBinary(inFile,n);
+
+        variable.values[i].setName(name);
+        variable.values[i].setUnits(units);
+        variable.values[i].resize(0);
+
+        qint64 nBytes = qint64(n)*qint64(sizeof(double));
+        if (variable.compressionType != R_VARIABLE_COMPRESSION_NONE)
+        {
+            qsizetype nCompressedBytes = 0;
+            RFileIO::readBinary(inFile,nCompressedBytes);
+            nBytes = qint64(nCompressedBytes);
+        }
+
+        if (!inFile.seek(inFile.pos() + nBytes))
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to skip %u variable values.",n);
+        }
+    }
+    RFileIO::readBinary(inFile,variable.variableData);
+    variable.invalidateStatistics();
+} /* RFileIO::readBinaryHeader */
+
+
 void RFileIO::writeAscii(RSaveFile &outFile, const RVariable &variable, bool addNewLine)
 {
     RFileIO::writeAscii(outFile,variable.type,addNewLine);
@@ -2027,10 +2319,30 @@ void RFileIO::writeBinary(RSaveFile &outFile, const RVariable &variable)
     RFileIO::writeBinary(outFile,variable.applyType);
     RFileIO::writeBinary(outFile,variable.name);
     RFileIO::writeBinary(outFile,variable.units);
+    RFileIO::writeBinary(outFile,variable.compressionType);
+    RFileIO::writeBinary(outFile,variable.compressionTolerance);
     RFileIO::writeBinary(outFile,(unsigned int)variable.values.size());
     for (unsigned int i=0;i<variable.values.size();i++)
     {
-        RFileIO::writeBinary(outFile,variable.values[i]);
+        if (variable.compressionType == R_VARIABLE_COMPRESSION_NONE)
+        {
+            RFileIO::writeBinary(outFile,variable.values[i]);
+            continue;
+        }
+
+        const RValueVector &valueVector = variable.values[i];
+        unsigned int n = valueVector.size();
+
+        RFileIO::writeBinary(outFile,valueVector.getName());
+        RFileIO::writeBinary(outFile,valueVector.getUnits());
+        RFileIO::writeBinary(outFile,n);
+
+        std::vector<double> values(n);
+        for (unsigned int j=0;j<n;j++)
+        {
+            values[j] = valueVector[j];
+        }
+        RFileIO::writeBinary(outFile,RVariableCompression::compress(values.data(),n,variable.compressionTolerance));
     }
     RFileIO::writeBinary(outFile,variable.variableData);
 } /* RFileIO::writeBinary */
@@ -2757,7 +3069,11 @@ void RFileIO::readAscii(RFile &inFile, RElement &element)
     RFileIO::readAscii(inFile,element.type);
     unsigned int nNodeIDs;
     RFileIO::readAscii(inFile,nNodeIDs);
-    element.nodeIDs.resize(nNodeIDs);
+    if (nNodeIDs > R_ELEMENT_MAX_NODES)
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid number of element nodes (%u).",nNodeIDs);
+    }
+    element.nNodes = nNodeIDs;
     for (unsigned int i=0;i<nNodeIDs;i++)
     {
         RFileIO::readAscii(inFile,element.nodeIDs[i]);
@@ -2770,7 +3086,11 @@ void RFileIO::readBinary(RFile &inFile, RElement &element)
     RFileIO::readBinary(inFile,element.type);
     unsigned int nNodeIDs;
     RFileIO::readBinary(inFile,nNodeIDs);
-    element.nodeIDs.resize(nNodeIDs);
+    if (nNodeIDs > R_ELEMENT_MAX_NODES)
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid number of element nodes (%u).",nNodeIDs);
+    }
+    element.nNodes = nNodeIDs;
     for (unsigned int i=0;i<nNodeIDs;i++)
     {
         RFileIO::readBinary(inFile,element.nodeIDs[i]);
@@ -2790,10 +3110,10 @@ void RFileIO::writeAscii(RSaveFile &outFile, const RElement &element, bool addNe
     {
         RFileIO::writeAscii(outFile,' ',false);
     }
-    for (unsigned int i=0;i<element.nodeIDs.size();i++)
+    for (unsigned int i=0;i<element.size();i++)
     {
         RFileIO::writeAscii(outFile,element.nodeIDs[i],addNewLine);
-        if (!addNewLine && i+1 < element.nodeIDs.size())
+        if (!addNewLine && i+1 < element.size())
         {
             RFileIO::writeAscii(outFile,' ',false);
         }
@@ -2805,13 +3125,234 @@ void RFileIO::writeBinary(RSaveFile &outFile, const RElement &element)
 {
     RFileIO::writeBinary(outFile,element.type);
     RFileIO::writeBinary(outFile,uint(element.size()));
-    for (unsigned int i=0;i<element.nodeIDs.size();i++)
+    for (unsigned int i=0;i<element.size();i++)
     {
         RFileIO::writeBinary(outFile,element.nodeIDs[i]);
     }
 }
 
 
+/*********************************************************************
+ *  Node and element blocks                                          *
+ *********************************************************************/
+
+
+void RFileIO::readBinaryBlock(RFile &inFile, std::vector<RNode> &nodes)
+{
+    static_assert(std::is_trivially_copyable<RNode>::value && sizeof(RNode) == 3*sizeof(double),
+                  "RNode must consist only of three double coordinates.");
+
+    unsigned int nNodes = 0;
+    RFileIO::readBinary(inFile,nNodes);
+    nodes.resize(nNodes);
+    RFileIO::readBinaryBlock(inFile,(double*)nodes.data(),3*qsizetype(nNodes));
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const std::vector<RNode> &nodes)
+{
+    static_assert(std::is_trivially_copyable<RNode>::value && sizeof(RNode) == 3*sizeof(double),
+                  "RNode must consist only of three double coordinates.");
+
+    RFileIO::writeBinary(outFile,uint(nodes.size()));
+    RFileIO::writeBinaryBlock(outFile,(const double*)nodes.data(),3*qsizetype(nodes.size()));
+} /* RFileIO::writeBinaryBlock */
+
+
+void RFileIO::readBinaryElementBlockHeader(RFile &inFile, std::vector<RElementType> &typeTable, unsigned int &nElements)
+{
+    // Element types are stored as ordinals to table of element type IDs.
+    unsigned int nTypeIds = 0;
+    RFileIO::readBinary(inFile,nTypeIds);
+    if (nTypeIds > 256)
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid number of element types (%u).",nTypeIds);
+    }
+    typeTable.resize(nTypeIds);
+    for (unsigned int i=0;i<nTypeIds;i++)
+    {
+        QString typeId;
+        RFileIO::readBinary(inFile,typeId);
+        typeTable[i] = RElement::getTypeFromId(typeId);
+        if (typeTable[i] == R_ELEMENT_NONE)
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Unknown element type \'%s\'.",typeId.toUtf8().constData());
+        }
+    }
+
+    RFileIO::readBinary(inFile,nElements);
+    if (qint64(nElements) > inFile.size() - inFile.pos())
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid number of elements (%u).",nElements);
+    }
+}
+
+void RFileIO::readBinaryBlock(RFile &inFile, std::vector<RElement> &elements)
+{
+    std::vector<RElementType> typeTable;
+    unsigned int nElements = 0;
+    RFileIO::readBinaryElementBlockHeader(inFile,typeTable,nElements);
+    unsigned int nTypeIds = uint(typeTable.size());
+
+    std::vector<uchar> typeOrdinals(nElements);
+    RFileIO::readBinaryBlock(inFile,(char*)typeOrdinals.data(),nElements);
+
+    // Element node count is given by its type, offsets are computed from types.
+    std::vector<RElementType> types(nElements);
+    std::vector<qsizetype> offsets(nElements+1,0);
+    for (unsigned int i=0;i<nElements;i++)
+    {
+        if (typeOrdinals[i] >= nTypeIds)
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid element type ordinal (%u).",uint(typeOrdinals[i]));
+        }
+        types[i] = typeTable[typeOrdinals[i]];
+        offsets[i+1] = offsets[i] + RElement::getNNodes(types[i]);
+    }
+
+    qsizetype nNodeIDs = 0;
+    RFileIO::readBinary(inFile,nNodeIDs);
+    if (nNodeIDs != offsets[nElements])
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Number of element node IDs (%lld) does not match element types (%lld).",
+                     (long long)nNodeIDs,(long long)offsets[nElements]);
+    }
+
+    std::vector<unsigned int> nodeIDs(nNodeIDs);
+    RFileIO::readBinaryBlock(inFile,nodeIDs.data(),nNodeIDs);
+
+    elements.resize(nElements);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElements);i++)
+    {
+        RElement &rElement = elements[i];
+        rElement.type = types[i];
+        rElement.nNodes = uint(offsets[i+1] - offsets[i]);
+        for (unsigned int j=0;j<rElement.nNodes;j++)
+        {
+            rElement.nodeIDs[j] = nodeIDs[offsets[i]+j];
+        }
+    }
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const std::vector<RElement> &elements)
+{
+    unsigned int nElements = uint(elements.size());
+
+    // Element types are stored as ordinals to table of element type IDs,
+    // so that file does not depend on numbering of element types.
+    std::vector<int> typeOrdinalBook(R_ELEMENT_N_TYPES,-1);
+    std::vector<RElementType> typeTable;
+    std::vector<uchar> typeOrdinals(nElements);
+    std::vector<qsizetype> offsets(nElements+1,0);
+    for (unsigned int i=0;i<nElements;i++)
+    {
+        RElementType type = elements[i].type;
+        if (typeOrdinalBook[type] < 0)
+        {
+            typeOrdinalBook[type] = int(typeTable.size());
+            typeTable.push_back(type);
+        }
+        typeOrdinals[i] = uchar(typeOrdinalBook[type]);
+        offsets[i+1] = offsets[i] + RElement::getNNodes(type);
+    }
+
+    std::vector<unsigned int> nodeIDs(offsets[nElements]);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElements);i++)
+    {
+        const RElement &rElement = elements[i];
+        for (unsigned int j=0;j<uint(offsets[i+1] - offsets[i]);j++)
+        {
+            nodeIDs[offsets[i]+j] = rElement.nodeIDs[j];
+        }
+    }
+
+    RFileIO::writeBinary(outFile,uint(typeTable.size()));
+    for (unsigned int i=0;i<typeTable.size();i++)
+    {
+        RFileIO::writeBinary(outFile,RElement::getId(typeTable[i]));
+    }
+    RFileIO::writeBinary(outFile,nElements);
+    RFileIO::writeBinaryBlock(outFile,(const char*)typeOrdinals.data(),nElements);
+    // Number of node IDs allows to skip connectivity block without reading element types.
+    RFileIO::writeBinary(outFile,offsets[nElements]);
+    RFileIO::writeBinaryBlock(outFile,nodeIDs.data(),offsets[nElements]);
+} /* RFileIO::writeBinaryBlock */
+
+
+void RFileIO::readBinaryBlock(RFile &inFile, std::vector<RUVector> &neighbors)
+{
+    unsigned int n = 0;
+    RFileIO::readBinary(inFile,n);
+
+    std::vector<unsigned int> sizes(n);
+    RFileIO::readBinaryBlock(inFile,sizes.data(),n);
+
+    std::vector<qsizetype> offsets(n+1,0);
+    for (unsigned int i=0;i<n;i++)
+    {
+        offsets[i+1] = offsets[i] + sizes[i];
+    }
+
+    qsizetype nIDs = 0;
+    RFileIO::readBinary(inFile,nIDs);
+    if (nIDs != offsets[n])
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Number of neighbor IDs (%lld) does not match neighbor counts (%lld).",
+                     (long long)nIDs,(long long)offsets[n]);
+    }
+
+    std::vector<unsigned int> ids(nIDs);
+    RFileIO::readBinaryBlock(inFile,ids.data(),nIDs);
+
+    neighbors.resize(n);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(n);i++)
+    {
+        RUVector &rNeighbors = neighbors[i];
+        rNeighbors.resize(sizes[i]);
+        for (unsigned int j=0;j<sizes[i];j++)
+        {
+            rNeighbors[j] = ids[offsets[i]+j];
+        }
+    }
+} /* RFileIO::readBinaryBlock */
+
+
+void RFileIO::writeBinaryBlock(RSaveFile &outFile, const std::vector<RUVector> &neighbors)
+{
+    unsigned int n = uint(neighbors.size());
+
+    std::vector<unsigned int> sizes(n);
+    qsizetype nIDs = 0;
+    for (unsigned int i=0;i<n;i++)
+    {
+        sizes[i] = neighbors[i].getNRows();
+        nIDs += sizes[i];
+    }
+
+    std::vector<unsigned int> ids;
+    ids.reserve(nIDs);
+    for (unsigned int i=0;i<n;i++)
+    {
+        for (unsigned int j=0;j<sizes[i];j++)
+        {
+            ids.push_back(neighbors[i][j]);
+        }
+    }
+
+    RFileIO::writeBinary(outFile,n);
+    RFileIO::writeBinaryBlock(outFile,sizes.data(),n);
+    RFileIO::writeBinary(outFile,nIDs);
+    RFileIO::writeBinaryBlock(outFile,ids.data(),nIDs);
+} /* RFileIO::writeBinaryBlock */
+
+
 /*********************************************************************
  *  RElementGroupVariableDisplayType                                 *
  *********************************************************************/
@@ -3521,6 +4062,19 @@ void RFileIO::readAscii(RFile &inFile, RStreamLine &streamLine)
     RFileIO::readAscii(inFile,static_cast<REntityGroup&>(streamLine));
     RFileIO::readAscii(inFile,streamLine.variableType);
     RFileIO::readAscii(inFile,streamLine.position);
+    streamLine.integrator = R_STREAM_LINE_INTEGRATOR_ELEMENT_WALK;
+    streamLine.tolerance = RStreamLine::defaultTolerance;
+    if (RFileIO::isBlockLayoutVersion(inFile.getVersion()))
+    {
+        int integrator = 0;
+        RFileIO::readAscii(inFile,integrator);
+        if (!R_STREAM_LINE_INTEGRATOR_IS_VALID(integrator))
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid RStreamLineIntegrator value %d.",integrator);
+        }
+        streamLine.integrator = RStreamLineIntegrator(integrator);
+        RFileIO::readAscii(inFile,streamLine.tolerance);
+    }
 }
 
 
@@ -3529,6 +4083,19 @@ void RFileIO::readBinary(RFile &inFile, RStreamLine &streamLine)
     RFileIO::readBinary(inFile,static_cast<REntityGroup&>(streamLine));
     RFileIO::readBinary(inFile,streamLine.variableType);
     RFileIO::readBinary(inFile,streamLine.position);
+    streamLine.integrator = R_STREAM_LINE_INTEGRATOR_ELEMENT_WALK;
+    streamLine.tolerance = RStreamLine::defaultTolerance;
+    if (RFileIO::isBlockLayoutVersion(inFile.getVersion()))
+    {
+        int integrator = 0;
+        RFileIO::readBinary(inFile,integrator);
+        if (!R_STREAM_LINE_INTEGRATOR_IS_VALID(integrator))
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid RStreamLineIntegrator value %d.",integrator);
+        }
+        streamLine.integrator = RStreamLineIntegrator(integrator);
+        RFileIO::readBinary(inFile,streamLine.tolerance);
+    }
 }
 
 
@@ -3545,6 +4112,16 @@ void RFileIO::writeAscii(RSaveFile &outFile, const RStreamLine &streamLine, bool
         RFileIO::writeAscii(outFile,' ',false);
     }
     RFileIO::writeAscii(outFile,streamLine.position,addNewLine);
+    if (!addNewLine)
+    {
+        RFileIO::writeAscii(outFile,' ',false);
+    }
+    RFileIO::writeAscii(outFile,int(streamLine.integrator),addNewLine);
+    if (!addNewLine)
+    {
+        RFileIO::writeAscii(outFile,' ',false);
+    }
+    RFileIO::writeAscii(outFile,streamLine.tolerance,addNewLine);
 }
 
 
@@ -3553,6 +4130,8 @@ void RFileIO::writeBinary(RSaveFile &outFile, const RStreamLine &streamLine)
     RFileIO::writeBinary(outFile,static_cast<const REntityGroup&>(streamLine));
     RFileIO::writeBinary(outFile,streamLine.variableType);
     RFileIO::writeBinary(outFile,streamLine.position);
+    RFileIO::writeBinary(outFile,int(streamLine.integrator));
+    RFileIO::writeBinary(outFile,streamLine.tolerance);
 }
 
 
@@ -1,6 +1,7 @@
 #include <cmath>
 #include <map>
 
+#include <rbl_error.h>
 #include <rbl_utils.h>
 
 #include "rml_interpolated_element.h"
@@ -11,17 +12,21 @@ void RInterpolatedElement::_init(const RInterpolatedElement *pInterpolatedElemen
 {
     if (pInterpolatedElement)
     {
-
+        this->nNodes = pInterpolatedElement->nNodes;
+        for (uint i=0;i<this->nNodes;i++)
+        {
+            this->nodes[i] = pInterpolatedElement->nodes[i];
+        }
     }
 }
 
 RInterpolatedElement::RInterpolatedElement()
+    : nNodes(0)
 {
     this->_init();
 }
 
 RInterpolatedElement::RInterpolatedElement(const RInterpolatedElement &interpolatedElement)
-    : std::vector<RInterpolatedNode>(interpolatedElement)
 {
     this->_init(&interpolatedElement);
 }
@@ -32,11 +37,28 @@ RInterpolatedElement::~RInterpolatedElement()
 
 RInterpolatedElement &RInterpolatedElement::operator =(const RInterpolatedElement &interpolatedElement)
 {
-    this->std::vector<RInterpolatedNode>::operator = (interpolatedElement);
     this->_init(&interpolatedElement);
     return (*this);
 }
 
+const RInterpolatedNode &RInterpolatedElement::at(uint position) const
+{
+    R_ERROR_ASSERT (position < this->nNodes);
+    return this->nodes[position];
+}
+
+RInterpolatedNode &RInterpolatedElement::at(uint position)
+{
+    R_ERROR_ASSERT (position < this->nNodes);
+    return this->nodes[position];
+}
+
+void RInterpolatedElement::push_back(const RInterpolatedNode &node)
+{
+    R_ERROR_ASSERT (this->nNodes < RInterpolatedElement::maxNodes);
+    this->nodes[this->nNodes++] = node;
+}
+
 void RInterpolatedElement::sortNodes(void)
 {
     this->removeDuplicateNodes();
@@ -1,5 +1,7 @@
 #include "rml_interpolated_entity.h"
 
+const uint RInterpolatedEntity::blockSize = 4096;
+
 void RInterpolatedEntity::_init(const RInterpolatedEntity *pInterpolatedEntity)
 {
     if (pInterpolatedEntity)
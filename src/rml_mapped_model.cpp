@@ -0,0 +1,355 @@
+#include <rbl_error.h>
+#include <rbl_logger.h>
+
+#include "rml_mapped_model.h"
+#include "rml_file_io.h"
+#include "rml_file_manager.h"
+#include "rml_model.h"
+
+RMappedModel::RMappedModel()
+    : pFile(nullptr)
+    , pData(nullptr)
+{
+
+}
+
+RMappedModel::~RMappedModel()
+{
+    this->close();
+}
+
+template <typename T>
+RMappedBlock<T> RMappedModel::mapBlock(qsizetype n)
+{
+    qint64 position = this->pFile->pos();
+    qint64 nBytes = qint64(n) * qint64(sizeof(T));
+    if (n < 0 || position + nBytes > this->pFile->size())
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Block of %lld values exceeds the end of file.",(long long)n);
+    }
+    if (!this->pFile->seek(position + nBytes))
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to skip block of %lld values.",(long long)n);
+    }
+    return RMappedBlock<T>(this->pData + position,n);
+}
+
+void RMappedModel::findElementOffsets(void) const
+{
+    if (!this->elementOffsets.empty())
+    {
+        return;
+    }
+#pragma omp critical(RMappedModel_findElementOffsets)
+    {
+        if (this->elementOffsets.empty())
+        {
+            std::vector<qsizetype> offsets(this->elementTypes.size()+1,0);
+            for (qsizetype i=0;i<this->elementTypes.size();i++)
+            {
+                offsets[i+1] = offsets[i] + RElement::getNNodes(this->elementTypeTable[this->elementTypes[i]]);
+            }
+            this->elementOffsets.swap(offsets);
+        }
+    }
+}
+
+void RMappedModel::open(const QString &fileName)
+{
+    this->close();
+
+    if (fileName.isEmpty())
+    {
+        throw RError(RError::Type::InvalidFileName,R_ERROR_REF,"No file name was provided.");
+    }
+
+    RLogger::info("Mapping binary model file \'%s\'\n",fileName.toUtf8().constData());
+
+    this->pFile = new RFile(fileName,RFile::BINARY);
+
+    if (!this->pFile->open(QIODevice::ReadOnly))
+    {
+        this->close();
+        throw RError(RError::Type::OpenFile,R_ERROR_REF,"Failed to open the file \'%s\'.",fileName.toUtf8().constData());
+    }
+
+    try
+    {
+        RFileHeader fileHeader;
+        RFileIO::readBinary(*this->pFile,fileHeader);
+        if (fileHeader.getType() == R_FILE_TYPE_LINK)
+        {
+            QString targetFileName(RFileManager::findLinkTargetFileName(fileName,fileHeader.getInformation()));
+            RLogger::info("File \'%s\' is a link file pointing to \'%s\'\n",fileName.toUtf8().constData(),targetFileName.toUtf8().constData());
+            this->open(targetFileName);
+            return;
+        }
+        if (fileHeader.getType() != R_FILE_TYPE_MODEL)
+        {
+            throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"File type of the file \'" + fileName + "\' is not MODEL.");
+        }
+        if (!RFileIO::isBlockLayoutVersion(fileHeader.getVersion()))
+        {
+            throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"File version %s of the file \'%s\' does not support mapping.",
+                         fileHeader.getVersion().toString().toUtf8().constData(),
+                         fileName.toUtf8().constData());
+        }
+        this->pFile->setVersion(fileHeader.getVersion());
+
+        this->pData = this->pFile->map(0,this->pFile->size());
+        if (!this->pData)
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to map the file \'%s\'.",fileName.toUtf8().constData());
+        }
+
+        RFile &modelFile = *this->pFile;
+
+        std::vector<qsizetype> sectionOffsets;
+        RFileIO::readBinary(modelFile,sectionOffsets);
+        std::vector<qsizetype> variableOffsets;
+        RFileIO::readBinary(modelFile,variableOffsets);
+        if (sectionOffsets.size() < R_MODEL_FILE_N_SECTIONS)
+        {
+            throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"Invalid section index in the file \'%s\'.",fileName.toUtf8().constData());
+        }
+
+        // Mesh/model values
+
+        RFileIO::readBinary(modelFile,this->name);
+        RFileIO::readBinary(modelFile,this->description);
+
+        uint nNodes = 0;
+        RFileIO::readBinary(modelFile,nNodes);
+        this->nodeCoordinates = this->mapBlock<double>(3*qsizetype(nNodes));
+
+        uint nElements = 0;
+        RFileIO::readBinaryElementBlockHeader(modelFile,this->elementTypeTable,nElements);
+        this->elementTypes = this->mapBlock<uchar>(nElements);
+        for (uint i=0;i<nElements;i++)
+        {
+            if (this->elementTypes[i] >= this->elementTypeTable.size())
+            {
+                throw RError(RError::Type::ReadFile,R_ERROR_REF,"Invalid element type ordinal (%u).",uint(this->elementTypes[i]));
+            }
+        }
+        qsizetype nNodeIDs = 0;
+        RFileIO::readBinary(modelFile,nNodeIDs);
+        this->elementNodeIDs = this->mapBlock<uint>(nNodeIDs);
+
+        // Sections between mesh and results are not needed.
+        if (!modelFile.seek(sectionOffsets[R_MODEL_FILE_SECTION_RESULTS]))
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to find results in the file \'%s\'.",fileName.toUtf8().constData());
+        }
+
+        // Results values
+
+        uint nResultsNodes = 0;
+        RFileIO::readBinary(modelFile,nResultsNodes);
+        uint nResultsElements = 0;
+        RFileIO::readBinary(modelFile,nResultsElements);
+        uint nVariables = 0;
+        RFileIO::readBinary(modelFile,nVariables);
+        this->variables.resize(nVariables);
+        this->variableValues.resize(nVariables);
+        for (uint i=0;i<nVariables;i++)
+        {
+            RVariableType type;
+            RFileIO::readBinary(modelFile,type);
+            RVariableApplyType applyType;
+            RFileIO::readBinary(modelFile,applyType);
+            QString variableName;
+            RFileIO::readBinary(modelFile,variableName);
+            QString variableUnits;
+            RFileIO::readBinary(modelFile,variableUnits);
+            RVariableCompressionType compressionType;
+            RFileIO::readBinary(modelFile,compressionType);
+            double compressionTolerance = 0.0;
+            RFileIO::readBinary(modelFile,compressionTolerance);
+            uint nVectors = 0;
+            RFileIO::readBinary(modelFile,nVectors);
+
+            RVariable &rVariable = this->variables[i];
+            rVariable.setType(type);
+            rVariable.setApplyType(applyType);
+            rVariable.setName(variableName);
+            rVariable.setUnits(variableUnits);
+            rVariable.setCompression(compressionType,compressionTolerance);
+            rVariable.resize(nVectors,0);
+
+            this->variableValues[i].resize(nVectors);
+            for (uint j=0;j<nVectors;j++)
+            {
+                QString vectorName;
+                RFileIO::readBinary(modelFile,vectorName);
+                QString vectorUnits;
+                RFileIO::readBinary(modelFile,vectorUnits);
+                uint nValues = 0;
+                RFileIO::readBinary(modelFile,nValues);
+                rVariable[j].setName(vectorName);
+                rVariable[j].setUnits(vectorUnits);
+                if (compressionType == R_VARIABLE_COMPRESSION_NONE)
+                {
+                    this->variableValues[i][j] = this->mapBlock<double>(nValues);
+                }
+                else
+                {
+                    // Compressed values can not be accessed in place and are held in memory.
+                    QByteArray data;
+                    RFileIO::readBinary(modelFile,data);
+                    QByteArray values(qsizetype(nValues)*qsizetype(sizeof(double)),Qt::Uninitialized);
+                    RVariableCompression::decompress(data,(double*)values.data(),nValues);
+                    qToLittleEndian<double>(values.constData(),nValues,values.data());
+                    this->decompressedValues.push_back(values);
+                    this->variableValues[i][j] = RMappedBlock<double>((const uchar*)values.constData(),nValues);
+                }
+            }
+
+            RVariableData variableData;
+            RFileIO::readBinary(modelFile,variableData);
+            rVariable.setVariableData(variableData);
+        }
+    }
+    catch (const RError &)
+    {
+        this->close();
+        throw;
+    }
+
+    RLogger::info("Mapped %u nodes, %u elements and %u variables\n",this->getNNodes(),this->getNElements(),this->getNVariables());
+}
+
+void RMappedModel::close(void)
+{
+    if (this->pFile)
+    {
+        if (this->pData)
+        {
+            this->pFile->unmap(const_cast<uchar*>(this->pData));
+        }
+        this->pFile->close();
+        delete this->pFile;
+    }
+    this->pFile = nullptr;
+    this->pData = nullptr;
+    this->name.clear();
+    this->description.clear();
+    this->nodeCoordinates = RMappedBlock<double>();
+    this->elementTypeTable.clear();
+    this->elementTypes = RMappedBlock<uchar>();
+    this->elementNodeIDs = RMappedBlock<uint>();
+    this->elementOffsets.clear();
+    this->variables.clear();
+    this->variableValues.clear();
+    this->decompressedValues.clear();
+}
+
+bool RMappedModel::isOpen(void) const
+{
+    return (this->pData != nullptr);
+}
+
+const QString &RMappedModel::getName(void) const
+{
+    return this->name;
+}
+
+const QString &RMappedModel::getDescription(void) const
+{
+    return this->description;
+}
+
+uint RMappedModel::getNNodes(void) const
+{
+    return uint(this->nodeCoordinates.size() / 3);
+}
+
+RNode RMappedModel::getNode(uint nodeID) const
+{
+    R_ERROR_ASSERT(nodeID < this->getNNodes());
+
+    qsizetype position = 3*qsizetype(nodeID);
+    return RNode(this->nodeCoordinates[position],
+                 this->nodeCoordinates[position+1],
+                 this->nodeCoordinates[position+2]);
+}
+
+const RMappedBlock<double> &RMappedModel::getNodeCoordinates(void) const
+{
+    return this->nodeCoordinates;
+}
+
+uint RMappedModel::getNElements(void) const
+{
+    return uint(this->elementTypes.size());
+}
+
+RElementType RMappedModel::getElementType(uint elementID) const
+{
+    R_ERROR_ASSERT(elementID < this->getNElements());
+
+    return this->elementTypeTable[this->elementTypes[elementID]];
+}
+
+RElement RMappedModel::getElement(uint elementID) const
+{
+    R_ERROR_ASSERT(elementID < this->getNElements());
+
+    this->findElementOffsets();
+
+    RElement element(this->getElementType(elementID));
+    qsizetype offset = this->elementOffsets[elementID];
+    for (uint i=0;i<element.size();i++)
+    {
+        element.setNodeId(i,this->elementNodeIDs[offset+i]);
+    }
+    return element;
+}
+
+uint RMappedModel::getNVariables(void) const
+{
+    return uint(this->variables.size());
+}
+
+uint RMappedModel::findVariable(RVariableType variableType) const
+{
+    for (uint i=0;i<this->variables.size();i++)
+    {
+        if (this->variables[i].getType() == variableType)
+        {
+            return i;
+        }
+    }
+    return RConstants::eod;
+}
+
+const RVariable &RMappedModel::getVariableHeader(uint position) const
+{
+    R_ERROR_ASSERT(position < this->variables.size());
+
+    return this->variables[position];
+}
+
+const RMappedBlock<double> &RMappedModel::getVariableValues(uint position, uint vecpos) const
+{
+    R_ERROR_ASSERT(position < this->variableValues.size());
+    R_ERROR_ASSERT(vecpos < this->variableValues[position].size());
+
+    return this->variableValues[position][vecpos];
+}
+
+RVariable RMappedModel::getVariable(uint position) const
+{
+    RVariable variable(this->getVariableHeader(position));
+    for (uint i=0;i<variable.getNVectors();i++)
+    {
+        const RMappedBlock<double> &values = this->variableValues[position][i];
+        variable[i].resize(values.size());
+        for (qsizetype j=0;j<values.size();j++)
+        {
+            variable[i][j] = values[j];
+        }
+    }
+    variable.invalidateStatistics();
+    return variable;
+}
@@ -1,11 +1,15 @@
+#include <QCryptographicHash>
 #include <QDir>
 #include <QSaveFile>
 #include <QFile>
 #include <QFileInfo>
 #include <QTextStream>
+#include <QtEndian>
 #include <QSetIterator>
 
+#include <atomic>
 #include <cmath>
+#include <map>
 #include <omp.h>
 #include <stack>
 #include <float.h>
@@ -15,15 +19,115 @@
 #include <rbl_progress.h>
 
 #include "rml_model.h"
+#include "rml_ascii_parser.h"
 #include "rml_file_io.h"
 #include "rml_file_manager.h"
+#include "rml_node_grid.h"
 #include "rml_view_factor_matrix.h"
 #include "rml_polygon.h"
 
+//! Element side key, elements with same side key share a side.
+struct ElementSideKey
+{
+    //! Sorted side node IDs, unused positions are set to RConstants::eod.
+    uint nodeIDs[4];
+    //! Element ID.
+    uint elementID;
+
+    bool operator <(const ElementSideKey &key) const
+    {
+        for (uint i=0;i<4;i++)
+        {
+            if (this->nodeIDs[i] != key.nodeIDs[i])
+            {
+                return (this->nodeIDs[i] < key.nodeIDs[i]);
+            }
+        }
+        return (this->elementID < key.elementID);
+    }
+
+    bool hasSameSide(const ElementSideKey &key) const
+    {
+        return (this->nodeIDs[0] == key.nodeIDs[0] &&
+                this->nodeIDs[1] == key.nodeIDs[1] &&
+                this->nodeIDs[2] == key.nodeIDs[2] &&
+                this->nodeIDs[3] == key.nodeIDs[3]);
+    }
+};
+
+//! Node positions of hexahedron faces.
+//! Element has no side table for hexahedra, bottom face nodes 0-3 are followed by top face nodes 4-7.
+static const uint hexaSideNodes[6][4] = { { 0, 1, 2, 3 },
+                                          { 4, 5, 6, 7 },
+                                          { 0, 1, 5, 4 },
+                                          { 1, 2, 6, 5 },
+                                          { 2, 3, 7, 6 },
+                                          { 3, 0, 4, 7 } };
+
+//! Return number of side keys of given element.
+//! Sides are edges of surface elements and faces of volume elements as defined by RElement::nodeIsOnEdge,
+//! hexahedron faces are given by hexaSideNodes.
+static uint findNSideKeys(const RElement &rElement)
+{
+    if (rElement.getType() == R_ELEMENT_HEXA1)
+    {
+        return 6;
+    }
+    uint nSideNodes = RElement::getNSideNodes(rElement.getType());
+    if (nSideNodes == 0 || nSideNodes > 4)
+    {
+        return 0;
+    }
+    return rElement.getNEdgeElements();
+}
+
+//! Fill side key of given element side.
+static void fillSideKey(const RElement &rElement, uint elementID, uint sidePosition, ElementSideKey &key)
+{
+    uint nSideNodes = 0;
+    if (rElement.getType() == R_ELEMENT_HEXA1)
+    {
+        for (uint i=0;i<4;i++)
+        {
+            key.nodeIDs[nSideNodes++] = rElement.getNodeId(hexaSideNodes[sidePosition][i]);
+        }
+    }
+    else
+    {
+        for (uint i=0;i<rElement.size() && nSideNodes < 4;i++)
+        {
+            if (rElement.nodeIsOnEdge(i,sidePosition))
+            {
+                key.nodeIDs[nSideNodes++] = rElement.getNodeId(i);
+            }
+        }
+    }
+    std::sort(key.nodeIDs,key.nodeIDs+nSideNodes);
+    for (uint i=nSideNodes;i<4;i++)
+    {
+        key.nodeIDs[i] = RConstants::eod;
+    }
+    key.elementID = elementID;
+}
+
 const RVersion RModel::version = RVersion(FILE_MAJOR_VERSION,FILE_MINOR_VERSION,FILE_RELEASE_VERSION);
 
 void RModel::_init (const RModel *pModel)
 {
+    // Caches are not copied, they are rebuilt on first use.
+    this->elementTree.clear();
+    this->elementTreeRevision.store(0,std::memory_order_relaxed);
+    this->nodeIncidence.clear();
+    this->nodeIncidenceRevision.store(0,std::memory_order_relaxed);
+    this->nodeGrid.reset();
+    this->nodeGridRevision = 0;
+    this->elementGroupMasks.clear();
+    this->elementGroupMasksRevision = 0;
+    this->meshHashRevision = 0;
+    this->connectivityHashRevision = 0;
+    this->meshRevision.store(1,std::memory_order_relaxed);
+    this->neighborsPending.store(false,std::memory_order_relaxed);
+    this->meshModified.store(false,std::memory_order_relaxed);
     if (pModel)
     {
         this->name = pModel->name;
@@ -41,6 +145,7 @@ void RModel::_init (const RModel *pModel)
         this->isos = pModel->isos;
         this->surfaceNeigs = pModel->surfaceNeigs;
         this->volumeNeigs = pModel->volumeNeigs;
+        this->neighborsPending.store(pModel->neighborsPending.load(std::memory_order_acquire),std::memory_order_relaxed);
         this->modelData = pModel->modelData;
     }
 } /* RModel::_init */
@@ -397,7 +502,7 @@ void RModel::update(const RModel &rModel)
 } /* RModel::update */
 
 
-void RModel::read(const QString &fileName)
+void RModel::read(const QString &fileName, bool loadVariablesOnDemand)
 {
     if (fileName.isEmpty())
     {
@@ -418,7 +523,7 @@ void RModel::read(const QString &fileName)
             }
             else if (ext == RModel::getDefaultFileExtension(true))
             {
-                targetFileName = this->readBinary(targetFileName);
+                targetFileName = this->readBinary(targetFileName,loadVariablesOnDemand);
             }
             else
             {
@@ -459,7 +564,7 @@ void RModel::read(const QString &fileName)
 } /* RModel::read */
 
 
-QString RModel::write(const QString &fileName, bool writeLinkFile) const
+QString RModel::write(const QString &fileName, bool writeLinkFile, const QString &baseFileName) const
 {
     if (fileName.isEmpty())
     {
@@ -499,7 +604,14 @@ QString RModel::write(const QString &fileName, bool writeLinkFile) const
         }
         else if (ext == RModel::getDefaultFileExtension(true))
         {
-            this->writeBinary(writeLinkFile?targetFileName:linkFileName);
+            if (baseFileName.isEmpty())
+            {
+                this->writeBinary(writeLinkFile?targetFileName:linkFileName);
+            }
+            else
+            {
+                this->writeBinaryResults(writeLinkFile?targetFileName:linkFileName,baseFileName);
+            }
         }
         else
         {
@@ -527,6 +639,25 @@ QString RModel::write(const QString &fileName, bool writeLinkFile) const
 } /* RModel::write */
 
 
+RModel RModel::createWriteSnapshot(const QString &fileName, const QString &baseFileName) const
+{
+    if (baseFileName.isEmpty() || RFileManager::getExtension(fileName) != RModel::getDefaultFileExtension(true))
+    {
+        return RModel(*this);
+    }
+
+    // Only results are written, mesh is represented by its hash.
+    RModel model;
+    model.RProblem::operator =(*this);
+    model.RResults::operator =(*this);
+    model.meshHash = this->findMeshHash();
+    model.meshHashRevision = model.getMeshRevision();
+    model.connectivityHash = this->findConnectivityHash();
+    model.connectivityHashRevision = model.getMeshRevision();
+    return model;
+} /* RModel::createWriteSnapshot */
+
+
 void RModel::exportTo (RModelMsh &modelMsh) const
 {
     modelMsh.clear();
@@ -840,7 +971,7 @@ void RModel::addElementToGroup (uint elementID,
 {
     R_ERROR_ASSERT (elementID < this->getNElements());
 
-    RElementType elementType = this->getElement(elementID).getType();
+    RElementType elementType = this->elements[elementID].getType();
 
     if (R_ELEMENT_TYPE_IS_POINT (elementType))
     {
@@ -1018,6 +1149,8 @@ void RModel::setNNodes (uint nnodes)
 {
     this->nodes.resize(nnodes);
     this->RResults::setNNodes (nnodes);
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
 } /* RModel::setNNodes */
 
 
@@ -1059,6 +1192,9 @@ void RModel::addNode(const RNode &node)
 {
     this->nodes.push_back (node);
     this->RResults::addNode(0.0);
+    this->invalidateElementTree();
+    this->clearStaleNodeIncidence();
+    this->nodeIncidence.addNode();
 } /* RModel::addNode */
 
 
@@ -1067,6 +1203,7 @@ void RModel::setNode (uint  position,
 {
     R_ERROR_ASSERT (position < this->nodes.size());
     this->nodes[position] = node;
+    this->invalidateElementTree();
 } /* RModel::set_node */
 
 
@@ -1088,6 +1225,9 @@ void RModel::removeNode(uint position)
 
     this->nodes.erase (iterNode);
     this->RResults::removeNode (position);
+    this->invalidateElementTree();
+    this->clearStaleNodeIncidence();
+    this->nodeIncidence.removeNode(position);
 
     // Decrease each node ID which is greater then possitin s by one
     for (std::vector<RElement>::iterator iterElement = this->elements.begin();
@@ -1167,57 +1307,106 @@ void RModel::mergeNodes(uint position1, uint position2, bool average, bool allow
 
     if (average)
     {
-        double x = (this->getNode(n1).getX() + this->getNode(n2).getX())/2.0;
-        double y = (this->getNode(n1).getY() + this->getNode(n2).getY())/2.0;
-        double z = (this->getNode(n1).getZ() + this->getNode(n2).getZ())/2.0;
+        double x = (this->nodes[n1].getX() + this->nodes[n2].getX())/2.0;
+        double y = (this->nodes[n1].getY() + this->nodes[n2].getY())/2.0;
+        double z = (this->nodes[n1].getZ() + this->nodes[n2].getZ())/2.0;
 
-        this->getNode(n1).set(x,y,z);
+        this->nodes[n1].set(x,y,z);
     }
 
-    for (uint i=0;i<this->getNElements();i++)
+    // Only elements containing second node are affected.
+    std::vector<uint> elementIDs = this->findElementPositionsByNodeId(n2);
+    this->clearStaleNodeIncidence();
+    for (uint i=0;i<elementIDs.size();i++)
     {
-        this->getElement(i).mergeNodes(n1,n2,allowDowngrade);
+        RElement oldElement(this->elements[elementIDs[i]]);
+        this->elements[elementIDs[i]].mergeNodes(n1,n2,allowDowngrade);
+        this->nodeIncidence.setElement(elementIDs[i],oldElement,this->elements[elementIDs[i]]);
     }
     this->removeNode(n2);
 } /* RModel::mergeNodes */
 
 
-std::vector<uint> RModel::findNearNodePositions(const RNode &node, double tolerance) const
+uint RModel::mergeNodes(const std::vector<uint> &mergeMap, bool allowDowngrade)
 {
-    double dl;
-    const RNode *pNode = nullptr;
-    std::vector<uint> nearNodes;
+    R_ERROR_ASSERT (mergeMap.size() == this->nodes.size());
 
-    for (uint i=0;i<this->nodes.size();i++)
+    // Replace merged nodes in elements.
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->elements.size());i++)
+    {
+        RElement &rElement = this->elements[uint(i)];
+        bool nodeMerged = true;
+        while (nodeMerged)
+        {
+            nodeMerged = false;
+            for (uint j=0;j<rElement.size();j++)
+            {
+                uint nodeID = rElement.getNodeId(j);
+                if (mergeMap[nodeID] != nodeID)
+                {
+                    // Element may be downgraded and its nodes reordered, therefore start over.
+                    rElement.mergeNodes(mergeMap[nodeID],nodeID,allowDowngrade);
+                    nodeMerged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<uint> nodeBook;
+    std::vector<uint> removeBook;
+    uint nNodes = RNodeGrid::findNodeBook(mergeMap,nodeBook,removeBook);
+    uint nMerged = uint(this->nodes.size()) - nNodes;
+
+    if (nMerged == 0)
     {
-        pNode = this->getNodePtr(i);
+        return 0;
+    }
 
-        dl = pNode->getDistance(node);
+    // Compact nodes and node results.
+    for (uint i=0;i<this->nodes.size();i++)
+    {
+        if (removeBook[i] != RConstants::eod)
+        {
+            this->nodes[removeBook[i]] = this->nodes[i];
+        }
+    }
+    this->nodes.resize(nNodes);
+    this->RResults::removeNodes(removeBook);
 
-        if (dl < tolerance)
+    // Renumber node IDs.
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->elements.size());i++)
+    {
+        RElement &rElement = this->elements[uint(i)];
+        for (uint j=0;j<rElement.size();j++)
         {
-            nearNodes.push_back(i);
+            rElement.setNodeId(j,nodeBook[rElement.getNodeId(j)]);
         }
     }
-    return nearNodes;
+
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
+
+    return nMerged;
+} /* RModel::mergeNodes */
+
+
+std::vector<uint> RModel::findNearNodePositions(const RNode &node, double tolerance) const
+{
+    return this->getNodeGrid(tolerance)->findNearNodes(this->nodes,node);
 } /* RModel::findNearNodePositions */
 
 
 uint RModel::mergeNearNodes(double tolerance)
 {
-    uint nMerged = 0;
-    for (uint i=0;i<this->getNNodes();i++)
+    std::vector<uint> mergeMap;
+    uint nMerged = RNodeGrid::findMergeMap(this->nodes,tolerance,mergeMap);
+
+    if (nMerged > 0)
     {
-        uint nodeID = i+1;
-        while (nodeID < this->getNNodes())
-        {
-            if (this->getNode(i).getDistance(this->getNode(nodeID)) <= tolerance)
-            {
-                this->mergeNodes(i,nodeID,false,true);
-                nMerged++;
-            }
-            nodeID++;
-        }
+        this->mergeNodes(mergeMap,true);
     }
 
     this->fixElementGroupRelations();
@@ -1227,54 +1416,20 @@ uint RModel::mergeNearNodes(double tolerance)
 
 uint RModel::removeDuplicateElements()
 {
-    RBVector elementBook(this->getNElements(),false);
-
-#pragma omp parallel for default(shared)
-    for(int64_t i=0;i<this->getNElements();i++)
+    std::vector<uint> elementIDs(this->getNElements());
+    for (uint i=0;i<elementIDs.size();i++)
     {
-        if (elementBook[uint(i)])
-        {
-            continue;
-        }
-        const RElement &rElement1 = this->getElement(uint(i));
-        for(int64_t j=i+1;j<this->getNElements();j++)
-        {
-            if (elementBook[uint(j)])
-            {
-                continue;
-            }
-            const RElement &rElement2 = this->getElement(uint(j));
-
-            if (rElement1.getType() != rElement2.getType())
-            {
-                continue;
-            }
-
-            bool isEqual = true;
-            for (uint k=0;k<rElement2.size();k++)
-            {
-                if (!rElement1.hasNodeId(rElement2.getNodeId(k)))
-                {
-                    isEqual = false;
-                    break;
-                }
-            }
-            if (isEqual)
-            {
-                elementBook[uint(j)] = true;
-            }
-        }
+        elementIDs[i] = i;
     }
 
+    std::vector<uint> duplicateIDs = this->findDuplicateElements(elementIDs);
+
     QList<uint> elementsToRemove;
-    elementsToRemove.reserve(int(this->getNElements()));
+    elementsToRemove.reserve(int(duplicateIDs.size()));
 
-    for (uint i=0;i<elementBook.size();i++)
+    for (uint i=0;i<duplicateIDs.size();i++)
     {
-        if (elementBook[i])
-        {
-            elementsToRemove.append(i);
-        }
+        elementsToRemove.append(duplicateIDs[i]);
     }
 
     uint nRemoved = this->getNElements();
@@ -1289,22 +1444,7 @@ uint RModel::removeDuplicateElements()
 
 void RModel::findNodeLimits(double &xmin, double &xmax, double &ymin, double &ymax, double &zmin, double &zmax) const
 {
-    xmin = xmax = ymin = ymax = zmin = zmax = 0.0;
-    for (uint i=0;i<this->nodes.size();i++)
-    {
-        if (i == 0)
-        {
-            xmin = xmax = this->getNode(i).getX();
-            ymin = ymax = this->getNode(i).getY();
-            zmin = zmax = this->getNode(i).getZ();
-        }
-        xmin = std::min(xmin,this->getNode(i).getX());
-        xmax = std::max(xmax,this->getNode(i).getX());
-        ymin = std::min(ymin,this->getNode(i).getY());
-        ymax = std::max(ymax,this->getNode(i).getY());
-        zmin = std::min(zmin,this->getNode(i).getZ());
-        zmax = std::max(zmax,this->getNode(i).getZ());
-    }
+    RNode::findNodeLimits(this->nodes,xmin,xmax,ymin,ymax,zmin,zmax);
 } /* RModel::getNodeLimits */
 
 
@@ -1393,14 +1533,8 @@ RStatistics RModel::findNodeDistanceStatistics() const
 
 bool RModel::isNodeUsed(uint nodeID) const
 {
-    for (uint i=0;i<this->getNElements();i++)
-    {
-        if (this->getElement(i).hasNodeId(nodeID))
-        {
-            return true;
-        }
-    }
-    return false;
+    R_ERROR_ASSERT (nodeID < this->nodes.size());
+    return (this->getNodeIncidence().getNElements(nodeID) > 0);
 } /* RModel::isNodeUsed */
 
 
@@ -1434,6 +1568,9 @@ uint RModel::purgeUnusedNodes()
         }
     }
 
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
+
     // Fix node IDs
     uint nNodes = 0;
     for (uint i=0;i<nodeBook.size();i++)
@@ -1504,6 +1641,8 @@ void RModel::setNElements (uint nelements)
 {
     this->elements.resize(nelements);
     this->RResults::setNElements(nelements);
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
 
     for (uint i=0;i<this->elements.size();i++)
     {
@@ -1574,6 +1713,9 @@ void RModel::addElement (const RElement &element,
 {
     this->elements.push_back(element);
     this->RResults::addElement(0.0);
+    this->invalidateElementTree();
+    this->clearStaleNodeIncidence();
+    this->nodeIncidence.addElement(element);
 
     if (addToGroup)
     {
@@ -1597,7 +1739,7 @@ void RModel::addElement (const RElement &element,
             oldGroupID = this->getNSurfaces();
             // Following works only for surface elements.
             double minNormalAngle = RConstants::pi;
-            const RElement &rElement = this->getElement(this->getNElements()-1);
+            const RElement &rElement = this->elements[this->getNElements()-1];
             RR3Vector en;
             rElement.findNormal(this->getNodes(),en[0],en[1],en[2]);
             for (uint i=0;i<this->getNSurfaces();i++)
@@ -1607,7 +1749,7 @@ void RModel::addElement (const RElement &element,
                 {
                     uint elementID = rSurface.get(j);
                     RR3Vector nn;
-                    this->getElement(elementID).findNormal(this->getNodes(),nn[0],nn[1],nn[2]);
+                    this->elements[elementID].findNormal(this->getNodes(),nn[0],nn[1],nn[2]);
 
                     double angle = RR3Vector::angle(en,nn);
                     if (angle < minNormalAngle)
@@ -1644,7 +1786,10 @@ void RModel::setElement (uint    position,
     REntityGroupType oldType = RElementGroup::getGroupType (this->elements[position].getType());
     REntityGroupType newType = RElementGroup::getGroupType (element.getType());
 
+    this->clearStaleNodeIncidence();
+    this->nodeIncidence.setElement(position,this->elements[position],element);
     this->elements[position] = element;
+    this->invalidateElementTree();
 
     if (oldType != newType)
     {
@@ -1708,7 +1853,7 @@ void RModel::removeElement(uint position, bool removeGroups)
     if (removeGroups)
     {
         // Remove element from element groups
-        RElementType elementType = this->getElement(position).getType();
+        RElementType elementType = this->elements[position].getType();
         uint ePosition;
         for (std::vector<RPoint>::reverse_iterator rIter = this->points.rbegin();rIter != this->points.rend();++rIter)
         {
@@ -1828,36 +1973,29 @@ void RModel::removeElement(uint position, bool removeGroups)
         }
     }
 
-    // Find which nodes should be removed.
+    // Find which nodes should be removed (nodes used only by removed element).
     std::vector<uint> nodesToRemove;
-    for (uint i=0;i<this->getElement(position).size();i++)
+    const RNodeIncidence &rNodeIncidence = this->getNodeIncidence();
+    for (uint i=0;i<this->elements[position].size();i++)
     {
-        uint nodeID = this->getElement(position).getNodeId(i);
-        bool nodeIsUsed = false;
-        for (uint j=0;j<this->getNElements() &&!nodeIsUsed;j++)
-        {
-            if (j == position)
-            {
-                continue;
-            }
-            if (this->getElement(j).hasNodeId(nodeID))
-            {
-                nodeIsUsed = true;
-            }
-        }
-        if (!nodeIsUsed)
+        uint nodeID = this->elements[position].getNodeId(i);
+        if (rNodeIncidence.getNElements(nodeID) <= 1)
         {
             nodesToRemove.push_back(nodeID);
         }
     }
     std::sort(nodesToRemove.begin(),nodesToRemove.end());
+    nodesToRemove.erase(std::unique(nodesToRemove.begin(),nodesToRemove.end()),nodesToRemove.end());
 
     // Remove element from elements vector
     std::vector<RElement>::iterator iter = this->elements.begin();
     std::advance (iter, position);
 
+    this->clearStaleNodeIncidence();
+    this->nodeIncidence.removeElement(position,*iter);
     this->elements.erase(iter);
     this->RResults::removeElement(position);
+    this->invalidateElementTree();
 
     // Remove node
     for (uint i=0;i<nodesToRemove.size();i++)
@@ -1922,147 +2060,632 @@ void RModel::removeElements(const QList<uint> &elementIDs, bool closeHole)
 
 std::vector<uint> RModel::findElementPositionsByNodeId(uint nodeID) const
 {
-    std::vector<uint> elementPositions;
-    const RElement *pElement = nullptr;
-
     R_ERROR_ASSERT (nodeID < this->getNNodes());
 
-    for (uint i=0;i<this->getNElements();i++)
-    {
-        pElement = this->getElementPtr (i);
-        if (pElement->hasNodeId(nodeID))
-        {
-            elementPositions.push_back(i);
-        }
-    }
-    return elementPositions;
+    return this->getNodeIncidence().getElementIDs(nodeID);
 } /* RModel::findElementPositionsByNodeId */
 
 
-RStatistics RModel::findLineElementSizeStatistics() const
-{
-    RRVector elementSizes;
-    return RStatistics(elementSizes,100,true);
-} /* RModel::findLineElementSizeStatistics */
-
-
-RStatistics RModel::findSurfaceElementSizeStatistics() const
-{
-    RRVector elementSizes;
-    return RStatistics(elementSizes,100,true);
-} /* RModel::findSurfaceElementSizeStatistics */
-
-
-RStatistics RModel::findVolumeElementSizeStatistics() const
+uint RModel::findElementContaining(const RNode &rNode, REntityGroupTypeMask entityGroup) const
 {
-    RRVector elementSizes;
-    return RStatistics(elementSizes,100,true);
-} /* RModel::findVolumeElementSizeStatistics */
+    RRVector volumes;
+    return this->findElementContaining(rNode,entityGroup,volumes);
+} /* RModel::findElementContaining */
 
 
-uint RModel::purgeUnusedElements()
+uint RModel::findElementContaining(const RNode &rNode, REntityGroupTypeMask entityGroup, RRVector &volumes) const
 {
-    RLogger::info("Purging unused elements\n");
-    RLogger::indent();
-
-    uint nElementGroups = this->getNElementGroups();
-
-    RLogger::info("Finding unused elements\n");
-    // Find unused elements
-    std::vector<uint> elementBook(this->getNElements(),RConstants::eod);
-
-    uint ne = this->getNElements();
+    std::vector<uint> candidateIDs;
+    this->getElementTree().findElementIDs(rNode,candidateIDs);
 
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(nElementGroups);i++)
+    for (uint i=0;i<candidateIDs.size();i++)
     {
-        const RElementGroup *pElementGroup = this->getElementGroupPtr(uint(i));
-        for (uint j=0;j<pElementGroup->size();j++)
+        const RElement &rElement = this->getElement(candidateIDs[i]);
+        if (RElementGroup::getGroupType(rElement.getType()) & entityGroup)
         {
-            elementBook[pElementGroup->get(j)] = 0;
+            if (rElement.isInside(this->getNodes(),rNode,volumes))
+            {
+                return candidateIDs[i];
+            }
         }
     }
 
-    RLogger::info("Removing unused elements\n");
-    RLogger::indent();
-    // Remove unused elements
-    std::vector<RElement> elementsNew;
-    elementsNew.reserve(ne);
-    for (uint i=0;i<ne;i++)
-    {
-        if (elementBook[i] != RConstants::eod)
-        {
-            elementsNew.push_back(this->elements[i]);
-        }
-    }
-    this->elements = elementsNew;
-    elementsNew.resize(0);
-    this->RResults::removeElements(elementBook);
-    RLogger::unindent();
+    return RConstants::eod;
+} /* RModel::findElementContaining */
 
-    RLogger::info("Fixing element ID references in element groups\n");
-    // Fix element ID references in element groups
-    uint nElements = 0;
-    for (uint i=0;i<elementBook.size();i++)
-    {
-        if (elementBook[i] != RConstants::eod)
-        {
-            elementBook[i] = nElements++;
-        }
-    }
 
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(nElementGroups);i++)
+uint RModel::findElementContaining(const RNode &rNode, REntityGroupTypeMask entityGroup, uint startElementID, RRVector &volumes) const
+{
+    if (startElementID != RConstants::eod)
     {
-        RElementGroup *pElementGroup = this->getElementGroupPtr(uint(i));
-        for (uint j=0;j<pElementGroup->size();j++)
+        const RElement &rStartElement = this->getElement(startElementID);
+        if (rStartElement.isInside(this->getNodes(),rNode,volumes))
         {
-            pElementGroup->set(j,elementBook[pElementGroup->get(j)]);
+            return startElementID;
         }
-    }
 
-    RLogger::info("Updating surface neighbors\n");
-    // Update surface neighbors
-    if (this->surfaceNeigs.size() == elementBook.size())
-    {
-        for (uint i=0;i<this->surfaceNeigs.size();i++)
+        // Walk to elements sharing a node with start element.
+        const RNodeIncidence &rNodeIncidence = this->getNodeIncidence();
+        for (uint i=0;i<rStartElement.size();i++)
         {
-            RUVector::reverse_iterator riter;
-            for (riter=this->surfaceNeigs[i].rbegin();riter!=this->surfaceNeigs[i].rend();++riter)
+            std::vector<uint> elementIDs = rNodeIncidence.getElementIDs(rStartElement.getNodeId(i));
+            for (uint j=0;j<elementIDs.size();j++)
             {
-                uint neigborID = (*riter);
-                if (elementBook[neigborID] == RConstants::eod)
+                if (elementIDs[j] == startElementID)
                 {
-                    this->surfaceNeigs[i].erase(--riter.base());
+                    continue;
                 }
-                else
+                const RElement &rElement = this->getElement(elementIDs[j]);
+                if (RElementGroup::getGroupType(rElement.getType()) & entityGroup)
                 {
-                    (*riter) = elementBook[neigborID];
+                    if (rElement.isInside(this->getNodes(),rNode,volumes))
+                    {
+                        return elementIDs[j];
+                    }
                 }
             }
         }
+    }
 
-        std::vector<RUVector> surfaceNeigsNew;
-        surfaceNeigsNew.reserve(elementBook.size());
+    return this->findElementContaining(rNode,entityGroup,volumes);
+} /* RModel::findElementContaining */
 
-        for (uint i=0;i<uint(elementBook.size());i++)
+
+bool RModel::findStreamLineDirection(const RVariable &rVariable, uint elementID, const RNode &rNode, const RRVector &volumes, RRVector &ratios, RR3Vector &direction) const
+{
+    direction[0] = direction[1] = direction[2] = 0.0;
+
+    uint nVectors = std::min(rVariable.getNVectors(),uint(3));
+
+    if (rVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
+    {
+        for (uint i=0;i<nVectors;i++)
         {
-            if (elementBook[i] != RConstants::eod)
+            direction[i] = rVariable.getValue(i,elementID);
+        }
+    }
+    else if (rVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
+    {
+        const RElement &rElement = this->getElement(elementID);
+        rElement.findInterpolationRatios(this->getNodes(),rNode,volumes,ratios);
+        for (uint j=0;j<ratios.size();j++)
+        {
+            uint nodeID = rElement.getNodeId(j);
+            for (uint i=0;i<nVectors;i++)
             {
-                surfaceNeigsNew.push_back(surfaceNeigs[i]);
+                direction[i] += ratios[j] * rVariable.getValue(i,nodeID);
             }
         }
-        this->surfaceNeigs = surfaceNeigsNew;
-        surfaceNeigsNew.resize(0);
     }
 
-    RLogger::info("Updating volume neighbors\n");
-    // Update volume neighbors
-    if (this->volumeNeigs.size() == elementBook.size())
+    if (direction.length() == 0.0)
     {
-        for (uint i=0;i<this->volumeNeigs.size();i++)
-        {
-            RUVector::reverse_iterator riter;
+        return false;
+    }
+    direction.normalize();
+    return true;
+} /* RModel::findStreamLineDirection */
+
+
+bool RModel::findStreamLineStep(const RVariable &rVariable, const RR3Vector &position, double step, uint &elementID, RRVector &volumes, RRVector &ratios, RR3Vector &nextPosition) const
+{
+    const double weights[4] = { 0.0, 0.5, 0.5, 1.0 };
+
+    RR3Vector k[4];
+    RR3Vector stagePosition(position);
+    uint stageElementID = elementID;
+
+    for (uint i=0;i<4;i++)
+    {
+        if (i > 0)
+        {
+            for (uint j=0;j<3;j++)
+            {
+                stagePosition[j] = position[j] + weights[i] * step * k[i-1][j];
+            }
+        }
+        RNode stageNode(stagePosition);
+        stageElementID = this->findElementContaining(stageNode,R_ENTITY_GROUP_VOLUME,stageElementID,volumes);
+        if (stageElementID == RConstants::eod)
+        {
+            return false;
+        }
+        if (!this->findStreamLineDirection(rVariable,stageElementID,stageNode,volumes,ratios,k[i]))
+        {
+            return false;
+        }
+    }
+
+    for (uint j=0;j<3;j++)
+    {
+        nextPosition[j] = position[j] + step * (k[0][j] + 2.0 * k[1][j] + 2.0 * k[2][j] + k[3][j]) / 6.0;
+    }
+
+    // End of the step must stay inside of the model.
+    elementID = this->findElementContaining(RNode(nextPosition),R_ENTITY_GROUP_VOLUME,stageElementID,volumes);
+    return (elementID != RConstants::eod);
+} /* RModel::findStreamLineStep */
+
+
+void RModel::traceStreamLine(RStreamLine &rStreamLine, const RVariable &rVariable, uint elementID, RRVector &volumes, RRVector &ratios) const
+{
+    RR3Vector vectorStart(rStreamLine.getPosition());
+    RR3Vector vectorStartNext;
+
+    RR3Vector oldVariableVector(0.0,0.0,0.0);
+    bool firstTime = true;
+
+    // Interpolation volumes are computed from element nodes.
+    volumes.resize(0);
+
+    while (elementID != RConstants::eod)
+    {
+        const RElement &rElement = this->getElement(elementID);
+
+        // Find variable vector
+        RR3Vector variableVector;
+        this->findStreamLineDirection(rVariable,elementID,RNode(vectorStart),volumes,ratios,variableVector);
+
+        // Find intersected element side/face
+        uint intersectedSide = rElement.findIntersectedSide(this->getNodes(),
+                                                            vectorStart,
+                                                            variableVector,
+                                                            vectorStartNext);
+
+        if (intersectedSide == RConstants::eod)
+        {
+            if (!firstTime)
+            {
+                // It could be that the vector is pointing back into the current element.
+                // Therefore this vector is replaced with the previous one to push it forward.
+                variableVector = oldVariableVector;
+                intersectedSide = rElement.findIntersectedSide(this->getNodes(),
+                                                               vectorStart,
+                                                               variableVector,
+                                                               vectorStartNext);
+            }
+            if (intersectedSide == RConstants::eod)
+            {
+                break;
+            }
+        }
+
+        RInterpolatedElement iElement;
+        iElement.push_back(RInterpolatedNode(elementID,vectorStart));
+        iElement.push_back(RInterpolatedNode(elementID,vectorStartNext));
+        rStreamLine.push_back(iElement);
+
+        elementID = this->getNeighbor(elementID,intersectedSide);
+
+        vectorStart = vectorStartNext;
+        oldVariableVector = variableVector;
+
+        firstTime = false;
+    }
+} /* RModel::traceStreamLine */
+
+
+void RModel::traceStreamLineRungeKutta(RStreamLine &rStreamLine, const RVariable &rVariable, uint elementID, RRVector &volumes, RRVector &ratios) const
+{
+    // Initial step is derived from size of the start element.
+    RElementTreeBox box;
+    RElementTree::findElementBox(this->getNodes(),this->getElement(elementID),box);
+    double elementSize = std::max(std::max(box.upper[0]-box.lower[0],box.upper[1]-box.lower[1]),box.upper[2]-box.lower[2]);
+    if (elementSize <= 0.0)
+    {
+        return;
+    }
+
+    double step = 0.5 * elementSize;
+    double minStep = 1.0e-6 * elementSize;
+    double maxStep = 4.0 * elementSize;
+    double tolerance = rStreamLine.getTolerance();
+
+    RR3Vector position(rStreamLine.getPosition());
+    RR3Vector fullPosition;
+    RR3Vector halfPosition;
+    RR3Vector nextPosition;
+
+    for (uint i=0;i<RStreamLine::maxSteps;i++)
+    {
+        // Error is estimated by comparing one full step with two half steps.
+        uint fullElementID = elementID;
+        uint nextElementID = elementID;
+        bool stepFound = (this->findStreamLineStep(rVariable,position,step,fullElementID,volumes,ratios,fullPosition)
+                          && this->findStreamLineStep(rVariable,position,0.5*step,nextElementID,volumes,ratios,halfPosition)
+                          && this->findStreamLineStep(rVariable,halfPosition,0.5*step,nextElementID,volumes,ratios,nextPosition));
+        double error = stepFound ? RR3Vector::findDistance(fullPosition,nextPosition) : 0.0;
+
+        if (!stepFound || error > tolerance * step)
+        {
+            // Step is leaving the model, crossing stagnation point or is not accurate enough.
+            step *= 0.5;
+            if (step < minStep)
+            {
+                break;
+            }
+            continue;
+        }
+
+        RInterpolatedElement iElement;
+        iElement.push_back(RInterpolatedNode(elementID,position));
+        iElement.push_back(RInterpolatedNode(nextElementID,nextPosition));
+        rStreamLine.push_back(iElement);
+
+        position = nextPosition;
+        elementID = nextElementID;
+
+        if (error < tolerance * step / 32.0)
+        {
+            step = std::min(2.0 * step,maxStep);
+        }
+    }
+} /* RModel::traceStreamLineRungeKutta */
+
+
+std::vector<uint> RModel::findElementsContaining(const std::vector<RNode> &nodes, REntityGroupTypeMask entityGroup, std::vector<RRVector> &volumes) const
+{
+    std::vector<uint> elementIDs(nodes.size(),RConstants::eod);
+    volumes.resize(nodes.size());
+
+    if (nodes.empty())
+    {
+        return elementIDs;
+    }
+
+    // Sort nodes along Morton (Z-order) curve so that consecutive nodes are close to each other.
+    double xmin, xmax, ymin, ymax, zmin, zmax;
+    RNode::findNodeLimits(nodes,xmin,xmax,ymin,ymax,zmin,zmax);
+    double size = std::max(std::max(xmax-xmin,ymax-ymin),zmax-zmin);
+    double scale = (size > 0.0) ? double((1 << 21) - 1) / size : 0.0;
+
+    std::vector< std::pair<uint64_t,uint> > order(nodes.size());
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodes.size());i++)
+    {
+        const uint64_t coordinates[3] = { uint64_t((nodes[uint(i)].getX() - xmin) * scale),
+                                          uint64_t((nodes[uint(i)].getY() - ymin) * scale),
+                                          uint64_t((nodes[uint(i)].getZ() - zmin) * scale) };
+        uint64_t key = 0;
+        for (uint j=0;j<21;j++)
+        {
+            for (uint k=0;k<3;k++)
+            {
+                key |= ((coordinates[k] >> j) & 1) << (3*j+k);
+            }
+        }
+        order[uint(i)] = std::pair<uint64_t,uint>(key,uint(i));
+    }
+    std::sort(order.begin(),order.end());
+
+    // Make sure search structures are built before entering parallel region.
+    this->getElementTree();
+    this->getNodeIncidence();
+
+    // Each thread processes continuous blocks of sorted nodes and walks from previously found element.
+    // Blocks are of fixed size, so that nodes on shared sides resolve to same element for any number of threads.
+    const size_t blockSize = 1024;
+    int64_t nBlocks = int64_t((nodes.size() + blockSize - 1) / blockSize);
+#pragma omp parallel for schedule(dynamic) default(shared)
+    for (int64_t i=0;i<nBlocks;i++)
+    {
+        size_t first = size_t(i) * blockSize;
+        size_t last = std::min(first + blockSize,nodes.size());
+
+        uint elementID = RConstants::eod;
+        for (size_t j=first;j<last;j++)
+        {
+            uint nodeID = order[j].second;
+            uint foundID = this->findElementContaining(nodes[nodeID],entityGroup,elementID,volumes[nodeID]);
+            if (foundID != RConstants::eod)
+            {
+                elementIDs[nodeID] = elementID = foundID;
+            }
+        }
+    }
+
+    return elementIDs;
+} /* RModel::findElementsContaining */
+
+
+void RModel::setMeshModified()
+{
+    // May be called from parallel loops, write shared flag only once.
+    if (!this->meshModified.load(std::memory_order_relaxed))
+    {
+        this->meshModified.store(true,std::memory_order_relaxed);
+    }
+} /* RModel::setMeshModified */
+
+
+uint64_t RModel::getMeshRevision() const
+{
+    if (this->meshModified.load(std::memory_order_acquire))
+    {
+#pragma omp critical (RModelMeshRevision)
+        {
+            if (this->meshModified.load(std::memory_order_relaxed))
+            {
+                // Revision must be increased before flag is reset and published.
+                this->meshRevision.fetch_add(1,std::memory_order_relaxed);
+                this->meshModified.store(false,std::memory_order_release);
+            }
+        }
+    }
+    return this->meshRevision.load(std::memory_order_acquire);
+} /* RModel::getMeshRevision */
+
+
+const RElementTree &RModel::getElementTree() const
+{
+    uint64_t revision = this->getMeshRevision();
+    // Lock only if tree needs to be built, tree published for current revision is only read.
+    if (this->elementTreeRevision.load(std::memory_order_acquire) != revision)
+    {
+#pragma omp critical (RModelElementTree)
+        {
+            if (this->elementTreeRevision.load(std::memory_order_relaxed) != revision)
+            {
+                this->elementTree.build(this->getNodes(),this->getElements());
+                this->elementTreeRevision.store(revision,std::memory_order_release);
+            }
+        }
+    }
+    return this->elementTree;
+} /* RModel::getElementTree */
+
+
+void RModel::invalidateElementTree()
+{
+    this->elementTree.clear();
+    this->elementTreeRevision.store(0,std::memory_order_release);
+    // Node grid and mesh hashes depend on nodes and elements same as element tree.
+#pragma omp critical (RModelNodeGrid)
+    {
+        this->nodeGrid.reset();
+        this->nodeGridRevision = 0;
+    }
+#pragma omp critical (RModelElementGroupMask)
+    {
+        this->elementGroupMasks.clear();
+        this->elementGroupMasksRevision = 0;
+    }
+#pragma omp critical (RModelMeshHash)
+    {
+        this->meshHashRevision = 0;
+    }
+#pragma omp critical (RModelConnectivityHash)
+    {
+        this->connectivityHashRevision = 0;
+    }
+} /* RModel::invalidateElementTree */
+
+
+std::shared_ptr<const std::vector<bool>> RModel::getElementGroupMask(const std::vector<uint> &elementGroupIDs) const
+{
+    // Group sizes are part of the key so that mask is rebuilt when group content changes.
+    std::vector<uint> key;
+    key.reserve(2*elementGroupIDs.size());
+    for (uint i=0;i<elementGroupIDs.size();i++)
+    {
+        const RElementGroup *pGrp = this->getElementGroupPtr(elementGroupIDs[i]);
+        key.push_back(elementGroupIDs[i]);
+        key.push_back(pGrp ? pGrp->size() : RConstants::eod);
+    }
+
+    uint64_t revision = this->getMeshRevision();
+    std::shared_ptr<const std::vector<bool>> mask;
+#pragma omp critical (RModelElementGroupMask)
+    {
+        if (this->elementGroupMasksRevision != revision)
+        {
+            this->elementGroupMasks.clear();
+            this->elementGroupMasksRevision = revision;
+        }
+        std::shared_ptr<const std::vector<bool>> &rMask = this->elementGroupMasks[key];
+        if (!rMask)
+        {
+            std::vector<bool> *pMask = new std::vector<bool>(this->getNElements(),false);
+            for (uint i=0;i<elementGroupIDs.size();i++)
+            {
+                const RElementGroup *pGrp = this->getElementGroupPtr(elementGroupIDs[i]);
+                if (pGrp)
+                {
+                    for (uint j=0;j<pGrp->size();j++)
+                    {
+                        (*pMask)[pGrp->get(j)] = true;
+                    }
+                }
+            }
+            rMask.reset(pMask);
+        }
+        mask = rMask;
+    }
+    return mask;
+} /* RModel::getElementGroupMask */
+
+
+std::shared_ptr<const RNodeGrid> RModel::getNodeGrid(double tolerance) const
+{
+    uint64_t revision = this->getMeshRevision();
+    std::shared_ptr<const RNodeGrid> grid;
+    // Grid is replaced and never modified so that queries running with previous tolerance keep their copy.
+#pragma omp critical (RModelNodeGrid)
+    {
+        if (!this->nodeGrid || this->nodeGridRevision != revision || this->nodeGrid->getTolerance() != std::max(tolerance,0.0))
+        {
+            RNodeGrid *pNodeGrid = new RNodeGrid(tolerance,RNodeGrid::findCellSize(this->nodes,tolerance));
+            pNodeGrid->insert(this->nodes);
+            this->nodeGrid.reset(pNodeGrid);
+            this->nodeGridRevision = revision;
+        }
+        grid = this->nodeGrid;
+    }
+    return grid;
+} /* RModel::getNodeGrid */
+
+
+const RNodeIncidence &RModel::getNodeIncidence() const
+{
+    uint64_t revision = this->getMeshRevision();
+    // Mutators patch incidence in place, it is rebuilt only after mesh was marked as modified.
+    if (this->nodeIncidenceRevision.load(std::memory_order_acquire) != revision)
+    {
+#pragma omp critical (RModelNodeIncidence)
+        {
+            if (this->nodeIncidenceRevision.load(std::memory_order_relaxed) != revision)
+            {
+                this->nodeIncidence.build(this->getNNodes(),this->getElements());
+                this->nodeIncidenceRevision.store(revision,std::memory_order_release);
+            }
+        }
+    }
+    return this->nodeIncidence;
+} /* RModel::getNodeIncidence */
+
+
+void RModel::invalidateNodeIncidence()
+{
+    this->nodeIncidence.clear();
+    this->nodeIncidenceRevision.store(0,std::memory_order_release);
+} /* RModel::invalidateNodeIncidence */
+
+
+void RModel::clearStaleNodeIncidence()
+{
+    if (this->nodeIncidenceRevision.load(std::memory_order_acquire) != this->getMeshRevision())
+    {
+        this->invalidateNodeIncidence();
+    }
+} /* RModel::clearStaleNodeIncidence */
+
+
+RStatistics RModel::findLineElementSizeStatistics() const
+{
+    RRVector elementSizes;
+    return RStatistics(elementSizes,100,true);
+} /* RModel::findLineElementSizeStatistics */
+
+
+RStatistics RModel::findSurfaceElementSizeStatistics() const
+{
+    RRVector elementSizes;
+    return RStatistics(elementSizes,100,true);
+} /* RModel::findSurfaceElementSizeStatistics */
+
+
+RStatistics RModel::findVolumeElementSizeStatistics() const
+{
+    RRVector elementSizes;
+    return RStatistics(elementSizes,100,true);
+} /* RModel::findVolumeElementSizeStatistics */
+
+
+uint RModel::purgeUnusedElements()
+{
+    RLogger::info("Purging unused elements\n");
+    RLogger::indent();
+
+    uint nElementGroups = this->getNElementGroups();
+
+    RLogger::info("Finding unused elements\n");
+    // Find unused elements
+    std::vector<uint> elementBook(this->getNElements(),RConstants::eod);
+
+    uint ne = this->getNElements();
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElementGroups);i++)
+    {
+        const RElementGroup *pElementGroup = this->getElementGroupPtr(uint(i));
+        for (uint j=0;j<pElementGroup->size();j++)
+        {
+            elementBook[pElementGroup->get(j)] = 0;
+        }
+    }
+
+    RLogger::info("Removing unused elements\n");
+    RLogger::indent();
+    // Remove unused elements
+    std::vector<RElement> elementsNew;
+    elementsNew.reserve(ne);
+    for (uint i=0;i<ne;i++)
+    {
+        if (elementBook[i] != RConstants::eod)
+        {
+            elementsNew.push_back(this->elements[i]);
+        }
+    }
+    this->elements = elementsNew;
+    elementsNew.resize(0);
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
+    this->RResults::removeElements(elementBook);
+    RLogger::unindent();
+
+    RLogger::info("Fixing element ID references in element groups\n");
+    // Fix element ID references in element groups
+    uint nElements = 0;
+    for (uint i=0;i<elementBook.size();i++)
+    {
+        if (elementBook[i] != RConstants::eod)
+        {
+            elementBook[i] = nElements++;
+        }
+    }
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nElementGroups);i++)
+    {
+        RElementGroup *pElementGroup = this->getElementGroupPtr(uint(i));
+        for (uint j=0;j<pElementGroup->size();j++)
+        {
+            pElementGroup->set(j,elementBook[pElementGroup->get(j)]);
+        }
+    }
+
+    RLogger::info("Updating surface neighbors\n");
+    // Update surface neighbors
+    if (this->surfaceNeigs.size() == elementBook.size())
+    {
+        for (uint i=0;i<this->surfaceNeigs.size();i++)
+        {
+            RUVector::reverse_iterator riter;
+            for (riter=this->surfaceNeigs[i].rbegin();riter!=this->surfaceNeigs[i].rend();++riter)
+            {
+                uint neigborID = (*riter);
+                if (elementBook[neigborID] == RConstants::eod)
+                {
+                    this->surfaceNeigs[i].erase(--riter.base());
+                }
+                else
+                {
+                    (*riter) = elementBook[neigborID];
+                }
+            }
+        }
+
+        std::vector<RUVector> surfaceNeigsNew;
+        surfaceNeigsNew.reserve(elementBook.size());
+
+        for (uint i=0;i<uint(elementBook.size());i++)
+        {
+            if (elementBook[i] != RConstants::eod)
+            {
+                surfaceNeigsNew.push_back(surfaceNeigs[i]);
+            }
+        }
+        this->surfaceNeigs = surfaceNeigsNew;
+        surfaceNeigsNew.resize(0);
+    }
+
+    RLogger::info("Updating volume neighbors\n");
+    // Update volume neighbors
+    if (this->volumeNeigs.size() == elementBook.size())
+    {
+        for (uint i=0;i<this->volumeNeigs.size();i++)
+        {
+            RUVector::reverse_iterator riter;
             for (riter=this->volumeNeigs[i].rbegin();riter!=this->volumeNeigs[i].rend();++riter)
             {
                 uint neigborID = (*riter);
@@ -3421,9 +4044,9 @@ void RModel::syncSurfaceNormals()
                         if (elementSurface[neighbourID] &&!elementChecked[neighbourID])
                         {
                             // Check neighbor orientation.
-                            if (!this->getElement(elementID).isNeighborNormalSync(this->getElement(neighbourID)))
+                            if (!this->elements[elementID].isNeighborNormalSync(this->elements[neighbourID]))
                             {
-                                this->getElement(neighbourID).swapNormal();
+                                this->elements[neighbourID].swapNormal();
                                 nSwapped++;
                             }
                             elementChecked[neighbourID] = true;
@@ -3440,6 +4063,10 @@ void RModel::syncSurfaceNormals()
             }
         }
     }
+    if (nSwapped > 0)
+    {
+        this->setMeshModified();
+    }
     RLogger::info("Number of swapped elements = %u\n",nSwapped);
 } /* RModel::syncSurfaceNormals */
 
@@ -4159,50 +4786,76 @@ RRVector RModel::getInterpolatedResultsValues(RVariableType variableType, const
     RRVector volumes;
 
     // Find element containing given position.
-    uint elementPos = RConstants::eod;
-    for (uint i=0;i<this->getNElements();i++)
-    {
-        const RElement &rElement = this->getElement(i);
-        if (RElementGroup::getGroupType(rElement.getType()) &entityGroup)
-        {
-            if (rElement.isInside(this->getNodes(),rNode,volumes))
-            {
-                elementPos = i;
-                break;
-            }
-        }
-    }
+    uint elementPos = this->findElementContaining(rNode,entityGroup,volumes);
     if (elementPos == RConstants::eod)
     {
         return RRVector();
     }
 
+    return this->findInterpolatedResultsValues(this->getVariable(variablePosition),elementPos,rNode,volumes);
+} /* RModel::getInterpolatedResultsValues */
+
+
+std::vector<RRVector> RModel::getInterpolatedResultsValues(RVariableType variableType, const std::vector<RNode> &nodes, REntityGroupTypeMask entityGroup) const
+{
+    std::vector<RRVector> resultsValues(nodes.size());
+
+    uint variablePosition = this->findVariable(variableType);
+    if (variablePosition == RConstants::eod || nodes.empty())
+    {
+        return resultsValues;
+    }
+
     const RVariable &rVariable = this->getVariable(variablePosition);
 
+    std::vector<RRVector> volumes;
+    std::vector<uint> elementIDs = this->findElementsContaining(nodes,entityGroup,volumes);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodes.size());i++)
+    {
+        if (elementIDs[uint(i)] != RConstants::eod)
+        {
+            resultsValues[uint(i)] = this->findInterpolatedResultsValues(rVariable,elementIDs[uint(i)],nodes[uint(i)],volumes[uint(i)]);
+        }
+    }
+
+    return resultsValues;
+} /* RModel::getInterpolatedResultsValues */
+
+
+RRVector RModel::findInterpolatedResultsValues(const RVariable &rVariable, uint elementID, const RNode &rNode, const RRVector &volumes) const
+{
     if (rVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
     {
-        return rVariable.getValueVector(elementPos);
+        return rVariable.getValueVector(elementID);
     }
     else if (rVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
     {
-        const RElement &rElement = this->getElement(elementPos);
-        RRVector nodeValues(rElement.size());
-
-        RRVector resultsValues(rVariable.getNVectors());
+        const RElement &rElement = this->getElement(elementID);
+        uint nVectors = rVariable.getNVectors();
 
-        for (uint i=0;i<rVariable.getNVectors();i++)
+        // Gather values of all components in one pass over element nodes.
+        std::vector<RRVector> nodeValues(nVectors,RRVector(rElement.size()));
+        for (uint j=0;j<rElement.size();j++)
         {
-            for (uint j=0;j<rElement.size();j++)
+            uint nodeID = rElement.getNodeId(j);
+            for (uint i=0;i<nVectors;i++)
             {
-                nodeValues[j] = rVariable.getValue(i,rElement.getNodeId(j));
+                nodeValues[i][j] = rVariable.getValue(i,nodeID);
             }
-            resultsValues[i] = rElement.interpolate(this->getNodes(),rNode,nodeValues,volumes);
+        }
+
+        RRVector resultsValues(nVectors);
+        for (uint i=0;i<nVectors;i++)
+        {
+            resultsValues[i] = rElement.interpolate(this->getNodes(),rNode,nodeValues[i],volumes);
         }
         return resultsValues;
     }
 
     return RRVector();
-} /* RModel::getInterpolatedResultsValues */
+} /* RModel::findInterpolatedResultsValues */
 
 
 /*************************************************************
@@ -4224,11 +4877,8 @@ void RModel::rotateGeometry(const QSet<uint> &nodeIDs, const RR3Vector &rotation
 
     RRMatrix R = RRMatrix::generateRotationMatrix(rx,ry,rz);
 
-    foreach (uint i, nodeIDs)
-    {
-        this->getNode(i).transform(R,t,true);
-        this->getNode(i).translate(rotationCenter);
-    }
+    RNode::transformNodes(this->nodes,std::vector<uint>(nodeIDs.begin(),nodeIDs.end()),R,t,rotationCenter);
+    this->invalidateElementTree();
 } /* RModel::rotateGeometry */
 
 
@@ -4238,12 +4888,8 @@ void RModel::scaleGeometry(const QSet<uint> &nodeIDs, const RR3Vector &scaleVect
     RLogger::info("  Vector: %s\n",scaleVector.toString(true).toUtf8().constData());
     RLogger::info("  Center: %s\n",scaleCenter.toString(true).toUtf8().constData());
 
-    foreach (uint i, nodeIDs)
-    {
-        this->getNode(i).translate(scaleCenter.getOpposite());
-        this->getNode(i).scale(scaleVector);
-        this->getNode(i).translate(scaleCenter);
-    }
+    RNode::scaleNodes(this->nodes,std::vector<uint>(nodeIDs.begin(),nodeIDs.end()),scaleVector,scaleCenter);
+    this->invalidateElementTree();
 } /* RModel::scaleGeometry */
 
 
@@ -4252,10 +4898,8 @@ void RModel::scaleGeometry(double scaleFactor)
     RLogger::info("Scale\n");
     RLogger::info("  Factor: %g\n",scaleFactor);
 
-    for (uint i=0;i<this->nodes.size();i++)
-    {
-        this->nodes[i].scale(scaleFactor);
-    }
+    RNode::scaleNodes(this->nodes,scaleFactor);
+    this->invalidateElementTree();
 } /* RModel::scaleGeometry */
 
 
@@ -4263,10 +4907,8 @@ void RModel::translateGeometry(const QSet<uint> &nodeIDs, const RR3Vector &trans
 {
     RLogger::info("Translate\n");
     RLogger::info("  Vector: %s\n",translateVector.toString(true).toUtf8().constData());
-    foreach (uint i, nodeIDs)
-    {
-        this->getNode(i).translate(translateVector);
-    }
+    RNode::translateNodes(this->nodes,std::vector<uint>(nodeIDs.begin(),nodeIDs.end()),translateVector);
+    this->invalidateElementTree();
 } /* RModel::translateGeometry */
 
 
@@ -4501,6 +5143,7 @@ QVector<bool> RModel::findEdgeNodes() const
     }
 
     // Add to edge nodes element nodes which neighbor count is less than expected.
+    this->findPendingNeighbors();
     if (this->surfaceNeigs.size() == this->getNElements())
     {
         for (uint i=0;i<this->getNSurfaces();i++)
@@ -4714,248 +5357,225 @@ double RModel::findMinimumNodeDistance() const
 
 void RModel::createCut(RCut &rCut) const
 {
-    std::vector<uint> elementIDs;
+    const RPlane &plane = rCut.getPlane();
 
-    const std::vector<uint> &elementGroupIDs = rCut.getElementGroupIDs();
-    for (uint i=0;i<elementGroupIDs.size();i++)
-    {
-        const RElementGroup *pGrp = this->getElementGroupPtr(elementGroupIDs[i]);
-        if (pGrp)
-        {
-            for (uint j=0;j<pGrp->size();j++)
-            {
-                elementIDs.push_back(pGrp->get(j));
-            }
-        }
-    }
+    // Only elements whose bounding box straddles the plane are tested.
+    // Element tree is kept between calls so moving the plane does not revisit whole mesh.
+    std::vector<uint> candidateIDs;
+    this->getElementTree().findElementIDs(plane,candidateIDs);
 
-    rCut.clear();
+    // Group membership mask is kept between calls as well.
+    std::shared_ptr<const std::vector<bool>> elementMarks = this->getElementGroupMask(rCut.getElementGroupIDs());
 
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(elementIDs.size());i++)
+    std::vector<uint> elementIDs;
+    for (uint i=0;i<candidateIDs.size();i++)
     {
-        const RElement &element = this->getElement(elementIDs[uint(i)]);
-
-        RInterpolatedElement iElement = element.createInterpolatedElement(rCut.getPlane(),this->getNodes(),elementIDs[uint(i)]);
-        if (iElement.size() > 0)
+        if ((*elementMarks)[candidateIDs[i]])
         {
-#pragma omp critical
-            {
-                rCut.push_back(iElement);
-            }
+            elementIDs.push_back(candidateIDs[i]);
         }
     }
+
+    rCut.createElements(uint(elementIDs.size()),[&](uint i)
+    {
+        return this->getElement(elementIDs[i]).createInterpolatedElement(plane,this->getNodes(),elementIDs[i]);
+    });
 } /* RModel::createCut */
 
 
 void RModel::createIso(RIso &rIso) const
 {
-    std::vector<uint> elementIDs;
+    this->createIsos(std::vector<RIso*>(1,&rIso));
+} /* RModel::createIso */
 
-    const std::vector<uint> &elementGroupIDs = rIso.getElementGroupIDs();
-    for (uint i=0;i<elementGroupIDs.size();i++)
+
+void RModel::createIsos(const std::vector<RIso *> &rIsos) const
+{
+    // Isos sharing variable and element groups are created together.
+    typedef std::map< std::pair< RVariableType,std::vector<uint> >,std::vector<RIso*> > IsoGroupMap;
+    IsoGroupMap isoGroups;
+    for (uint i=0;i<rIsos.size();i++)
     {
-        const RElementGroup *pGrp = this->getElementGroupPtr(elementGroupIDs[i]);
-        if (pGrp)
+        isoGroups[std::pair< RVariableType,std::vector<uint> >(rIsos[i]->getVariableType(),rIsos[i]->getElementGroupIDs())].push_back(rIsos[i]);
+    }
+
+    for (IsoGroupMap::const_iterator iter = isoGroups.cbegin(); iter != isoGroups.cend(); ++iter)
+    {
+        const std::vector<uint> &elementGroupIDs = iter->first.second;
+        const std::vector<RIso*> &groupIsos = iter->second;
+
+        for (uint i=0;i<groupIsos.size();i++)
         {
-            for (uint j=0;j<pGrp->size();j++)
-            {
-                elementIDs.push_back(pGrp->get(j));
-            }
+            groupIsos[i]->clear();
         }
-    }
 
-    rIso.clear();
+        uint variablePosition = this->findVariable(iter->first.first);
+        if (variablePosition == RConstants::eod)
+        {
+            continue;
+        }
 
-    uint variablePosition = this->findVariable(rIso.getVariableType());
-    if (variablePosition == RConstants::eod)
-    {
-        return;
-    }
+        const RVariable &rVariable = this->getVariable(variablePosition);
 
-    const RVariable &rVariable = this->getVariable(variablePosition);
+        std::vector<uint> elementIDs;
+        for (uint i=0;i<elementGroupIDs.size();i++)
+        {
+            const RElementGroup *pGrp = this->getElementGroupPtr(elementGroupIDs[i]);
+            if (pGrp)
+            {
+                for (uint j=0;j<pGrp->size();j++)
+                {
+                    elementIDs.push_back(pGrp->get(j));
+                }
+            }
+        }
 
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(elementIDs.size());i++)
-    {
-        const RElement &rElement = this->getElement(elementIDs[uint(i)]);
-        std::vector<double> nodeValues;
-        nodeValues.resize(rElement.size(),0.0);
-        for (uint j=0;j<rElement.size();j++)
+        // Iso values sorted in ascending order together with position of their iso.
+        std::vector< std::pair<double,uint> > levels(groupIsos.size());
+        std::vector<RInterpolatedEntity*> entities(groupIsos.size());
+        for (uint i=0;i<groupIsos.size();i++)
+        {
+            levels[i] = std::pair<double,uint>(groupIsos[i]->getVariableValue(),i);
+            entities[i] = groupIsos[i];
+        }
+        std::sort(levels.begin(),levels.end());
+
+        // Node values of each element are gathered once and only levels within their range are tested.
+        RInterpolatedEntity::createElements(entities,uint(elementIDs.size()),[&](uint i, std::vector< std::vector<RInterpolatedElement> > &elements)
         {
-            if (rVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
+            const RElement &rElement = this->getElement(elementIDs[i]);
+            std::vector<double> nodeValues;
+            nodeValues.resize(rElement.size(),0.0);
+            for (uint j=0;j<rElement.size();j++)
             {
-                nodeValues[j] = rVariable.getValue(rElement.getNodeId(j));
+                if (rVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
+                {
+                    nodeValues[j] = rVariable.getValue(rElement.getNodeId(j));
+                }
+                else if (rVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
+                {
+                    nodeValues[j] = rVariable.getValue(elementIDs[i]);
+                }
             }
-            else if (rVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
+            if (nodeValues.empty())
             {
-                nodeValues[j] = rVariable.getValue(elementIDs[uint(i)]);
+                return;
             }
-        }
 
-        RInterpolatedElement iElement = rElement.createInterpolatedElement(rIso.getVariableValue(),nodeValues,this->getNodes(),elementIDs[uint(i)]);
-        if (iElement.size() > 0)
-        {
-#pragma omp critical
+            double minValue = *std::min_element(nodeValues.begin(),nodeValues.end());
+            double maxValue = *std::max_element(nodeValues.begin(),nodeValues.end());
+
+            std::vector< std::pair<double,uint> >::const_iterator levelIter = std::lower_bound(levels.cbegin(),levels.cend(),minValue,
+                                                                                               [](const std::pair<double,uint> &level, double value)
             {
-                rIso.push_back(iElement);
+                return level.first < value;
+            });
+            for (;levelIter != levels.cend() && levelIter->first <= maxValue;++levelIter)
+            {
+                RInterpolatedElement iElement = rElement.createInterpolatedElement(levelIter->first,nodeValues,this->getNodes(),elementIDs[i]);
+                if (!iElement.empty())
+                {
+                    elements[levelIter->second].push_back(iElement);
+                }
             }
-        }
+        });
     }
-} /* RModel::createIso */
+} /* RModel::createIsos */
 
 
 void RModel::createStreamLine(RStreamLine &rStreamLine) const
 {
-    rStreamLine.clear();
+    this->createStreamLines(std::vector<RStreamLine*>(1,&rStreamLine));
+} /* RModel::createStreamLine */
 
-    uint variablePosition = this->findVariable(rStreamLine.getVariableType());
-    if (variablePosition == RConstants::eod)
+
+void RModel::createStreamLines(const std::vector<RStreamLine *> &rStreamLines) const
+{
+    std::vector<RNode> startNodes(rStreamLines.size());
+    for (uint i=0;i<rStreamLines.size();i++)
     {
-        return;
+        rStreamLines[i]->clear();
+        startNodes[i] = RNode(rStreamLines[i]->getPosition());
     }
-    const RVariable &rVariable = this->getVariable(variablePosition);
-
-    RNode startNode(rStreamLine.getPosition());
 
-    // Find starting element.
-    uint pointElementID = RConstants::eod;
-    uint lineElementID = RConstants::eod;
-    uint surfaceElementID = RConstants::eod;
-    uint volumeElementID = RConstants::eod;
-
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(this->getNElements());i++)
+    // Find starting elements, volume elements take precedence over surfaces, lines and points.
+    // All start positions are located at once through element tree.
+    std::vector<uint> startElementIDs(rStreamLines.size(),RConstants::eod);
+    const REntityGroupTypeMask entityGroups[4] = { R_ENTITY_GROUP_VOLUME,
+                                                   R_ENTITY_GROUP_SURFACE,
+                                                   R_ENTITY_GROUP_LINE,
+                                                   R_ENTITY_GROUP_POINT };
+    for (uint i=0;i<4;i++)
     {
-        const RElement &rElement = this->getElement(uint(i));
-
-        if (R_ELEMENT_TYPE_IS_POINT(rElement.getType()) &&pointElementID == RConstants::eod)
-        {
-            if (rElement.isInside(this->getNodes(),startNode))
-            {
-                pointElementID = uint(i);
-            }
-        }
-        if (R_ELEMENT_TYPE_IS_LINE(rElement.getType()) &&lineElementID == RConstants::eod)
+        std::vector<uint> positions;
+        std::vector<RNode> nodes;
+        for (uint j=0;j<startNodes.size();j++)
         {
-            if (rElement.isInside(this->getNodes(),startNode))
+            if (startElementIDs[j] == RConstants::eod)
             {
-                lineElementID = uint(i);
+                positions.push_back(j);
+                nodes.push_back(startNodes[j]);
             }
         }
-        if (R_ELEMENT_TYPE_IS_SURFACE(rElement.getType()) &&surfaceElementID == RConstants::eod)
+        if (nodes.empty())
         {
-            if (rElement.isInside(this->getNodes(),startNode))
-            {
-                surfaceElementID = uint(i);
-            }
+            break;
         }
-        if (R_ELEMENT_TYPE_IS_VOLUME(rElement.getType()) &&volumeElementID == RConstants::eod)
+        std::vector<RRVector> volumes;
+        std::vector<uint> elementIDs = this->findElementsContaining(nodes,entityGroups[i],volumes);
+        for (uint j=0;j<positions.size();j++)
         {
-            if (rElement.isInside(this->getNodes(),startNode))
-            {
-                volumeElementID = uint(i);
-            }
+            startElementIDs[positions[j]] = elementIDs[j];
         }
     }
 
-    uint elementID = RConstants::eod;
-
-    elementID = (pointElementID != RConstants::eod) ? pointElementID : elementID;
-    elementID = (lineElementID != RConstants::eod) ? lineElementID : elementID;
-    elementID = (surfaceElementID != RConstants::eod) ? surfaceElementID : elementID;
-    elementID = (volumeElementID != RConstants::eod) ? volumeElementID : elementID;
-
-    if (elementID == RConstants::eod)
-    {
-        RLogger::warning("Could not find start of the stream line \'%s\'\n",this->getName().toUtf8().constData());
-        return;
-    }
-
-    RR3Vector vectorStart(startNode.toVector());
-    RR3Vector vectorStartNext;
-
-    // Find variable vector
-    RR3Vector oldVariableVector(0.0,0.0,0.0);
-    bool firstTime = true;
+    // Make sure search structures are built before entering parallel region.
+    this->getElementTree();
+    this->getNodeIncidence();
 
-    while (elementID != RConstants::eod)
+#pragma omp parallel default(shared)
     {
-        const RElement &rElement = this->getElement(elementID);
+        // Scratch buffers are allocated once per thread and reused in all steps.
+        RRVector volumes;
+        RRVector ratios;
 
-        // Find variable vector
-        RR3Vector variableVector(0.0,0.0,0.0);
-        if (rVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
+#pragma omp for schedule(dynamic)
+        for (int64_t i=0;i<int64_t(rStreamLines.size());i++)
         {
-            if (rVariable.getNVectors() > 0)
+            RStreamLine &rStreamLine = *rStreamLines[uint(i)];
+            uint elementID = startElementIDs[uint(i)];
+            if (elementID == RConstants::eod)
             {
-                variableVector[0] = rVariable.getValue(0,elementID);
-            }
-            if (rVariable.getNVectors() > 1)
-            {
-                variableVector[1] = rVariable.getValue(1,elementID);
-            }
-            if (rVariable.getNVectors() > 2)
-            {
-                variableVector[2] = rVariable.getValue(2,elementID);
+                continue;
             }
-        }
-        else if (rVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
-        {
-            std::vector<double> nodeValues;
-            nodeValues.resize(rElement.size(),0);
 
-            for (uint i=0;i<rVariable.getNVectors() &&i<3;i++)
+            uint variablePosition = this->findVariable(rStreamLine.getVariableType());
+            if (variablePosition == RConstants::eod)
             {
-                for (uint j=0;j<rElement.size();j++)
-                {
-                    nodeValues[j] = rVariable.getValue(i,rElement.getNodeId(j));
-                }
-                variableVector[i] = rElement.interpolate(this->getNodes(),RNode(vectorStart),nodeValues);
+                continue;
             }
-        }
-        variableVector.normalize();
-
-        // Find intersected element side/face
-        uint intersectedSide = rElement.findIntersectedSide(this->getNodes(),
-                                                            vectorStart,
-                                                            variableVector,
-                                                            vectorStartNext);
+            const RVariable &rVariable = this->getVariable(variablePosition);
 
-        if (intersectedSide == RConstants::eod)
-        {
-            if (!firstTime)
+            if (rStreamLine.getIntegrator() == R_STREAM_LINE_INTEGRATOR_RUNGE_KUTTA_4
+                && RElementGroup::getGroupType(this->getElement(elementID).getType()) == R_ENTITY_GROUP_VOLUME)
             {
-                // It could be that the vector is pointing back into the current element.
-                // Therefore this vector is replaced with the previous one to push it forward.
-                variableVector = oldVariableVector;
-                intersectedSide = rElement.findIntersectedSide(this->getNodes(),
-                                                               vectorStart,
-                                                               variableVector,
-                                                               vectorStartNext);
+                this->traceStreamLineRungeKutta(rStreamLine,rVariable,elementID,volumes,ratios);
             }
-            if (intersectedSide == RConstants::eod)
+            else
             {
-                break;
+                this->traceStreamLine(rStreamLine,rVariable,elementID,volumes,ratios);
             }
         }
+    }
 
-        RInterpolatedElement iElement;
-        iElement.push_back(RInterpolatedNode(elementID,vectorStart));
-        iElement.push_back(RInterpolatedNode(elementID,vectorStartNext));
-        if (iElement.size() > 0)
+    for (uint i=0;i<rStreamLines.size();i++)
+    {
+        if (startElementIDs[i] == RConstants::eod)
         {
-            rStreamLine.push_back(iElement);
+            RLogger::warning("Could not find start of the stream line \'%s\'\n",rStreamLines[i]->getName().toUtf8().constData());
         }
-
-        elementID = this->getNeighbor(elementID,intersectedSide);
-
-        vectorStart = vectorStartNext;
-        oldVariableVector = variableVector;
-
-        firstTime = false;
     }
-} /* RModel::createStreamLine */
+} /* RModel::createStreamLines */
 
 
 void RModel::createDependentEntities()
@@ -4964,14 +5584,18 @@ void RModel::createDependentEntities()
     {
         this->createCut(this->getCut(i));
     }
+    std::vector<RIso*> rIsos(this->getNIsos());
     for (uint i=0;i<this->getNIsos();i++)
     {
-        this->createIso(this->getIso(i));
+        rIsos[i] = &this->getIso(i);
     }
+    this->createIsos(rIsos);
+    std::vector<RStreamLine*> rStreamLines(this->getNStreamLines());
     for (uint i=0;i<this->getNStreamLines();i++)
     {
-        this->createStreamLine(this->getStreamLine(i));
+        rStreamLines[i] = &this->getStreamLine(i);
     }
+    this->createStreamLines(rStreamLines);
 } /* RModel::createDependentEntities */
 
 
@@ -5000,6 +5624,8 @@ uint RModel::getNeighbor(uint elementID, uint neighborPosition) const
 
 const std::vector<uint> *RModel::getNeighborIDs(uint elementID) const
 {
+    this->findPendingNeighbors();
+
     switch (this->getElement(elementID).getType())
     {
         case R_ELEMENT_TRI1:
@@ -5029,6 +5655,30 @@ const std::vector<uint> *RModel::getNeighborIDs(uint elementID) const
 } /* RModel::getNeighborIDs */
 
 
+void RModel::findPendingNeighbors() const
+{
+    if (!this->neighborsPending.load(std::memory_order_acquire))
+    {
+        return;
+    }
+#pragma omp critical (RModelNeighbors)
+    {
+        if (this->neighborsPending.load(std::memory_order_relaxed))
+        {
+            if (this->surfaceNeigs.size() != this->getNElements())
+            {
+                this->surfaceNeigs = this->findSurfaceNeighbors();
+            }
+            if (this->volumeNeigs.size() != this->getNElements())
+            {
+                this->volumeNeigs = this->findVolumeNeighbors();
+            }
+            this->neighborsPending.store(false,std::memory_order_release);
+        }
+    }
+} /* RModel::findPendingNeighbors */
+
+
 void RModel::setSurfaceNeighbors(const std::vector<RUVector> &surfaceNeigs)
 {
     R_ERROR_ASSERT (surfaceNeigs.size() == this->getNElements());
@@ -5045,12 +5695,14 @@ void RModel::setVolumeNeighbors(const std::vector<RUVector> &volumeNeigs)
 
 void RModel::clearSurfaceNeighbors()
 {
+    this->neighborsPending.store(false,std::memory_order_release);
     this->surfaceNeigs.clear();
 } /* RModel::clearSurfaceNeighbors */
 
 
 void RModel::clearVolumeNeighbors()
 {
+    this->neighborsPending.store(false,std::memory_order_release);
     this->volumeNeigs.clear();
 } /* RModel::clearVolumeNeighbors */
 
@@ -5324,57 +5976,62 @@ QList<uint> RModel::findIntersectedElements() const
     RLogger::info("Finding intersected elements\n");
     RLogger::indent();
 
-    QVector<bool> intElements;
-    intElements.resize(int(this->getNElements()));
-    intElements.fill(false);
-
-    QVector<RLimitBox> limitBoxes(this->getNElements());
-    for (uint i=0;i<this->getNElements();i++)
+    std::vector<RLimitBox> limitBoxes(this->getNElements());
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->getNElements());i++)
     {
-        this->getElement(i).findLimitBox(this->getNodes(),limitBoxes[i]);
+        this->getElement(uint(i)).findLimitBox(this->getNodes(),limitBoxes[uint(i)]);
     }
 
+    // Broad phase - find pairs of elements with intersecting bounding boxes.
+    std::vector< std::pair<uint,uint> > elementPairs;
+    this->getElementTree().findElementPairs(elementPairs);
+    RLogger::info("Number of candidate element pairs = %u\n",uint(elementPairs.size()));
+
+    // Narrow phase - each thread collects intersected elements in to its own buffer.
+    std::vector< std::vector<uint> > threadElementIDs(uint(omp_get_max_threads()));
+
     RProgressInitialize("Finding intersected elements");
-    const uint64_t n_total = uint64_t(this->getNElements()) * (this->getNElements() - 1) / 2;
+    const uint64_t n_total = uint64_t(elementPairs.size());
     std::atomic<uint64_t> n_count(0);
-#pragma omp parallel for schedule(dynamic) default(shared)
-    for (int64_t i=0;i<int64_t(this->getNElements());i++)
+#pragma omp parallel for schedule(dynamic,256) default(shared)
+    for (int64_t i=0;i<int64_t(elementPairs.size());i++)
     {
-#pragma omp critical
+        uint64_t count = n_count.fetch_add(1, std::memory_order_relaxed);
+        if ((count % 1000) == 0 && omp_get_thread_num() == 0)
         {
-            RProgressPrint(n_count,n_total);
+            RProgressPrint(count, n_total);
         }
-        if ((i % 100) == 0)
+
+        uint e1 = elementPairs[uint(i)].first;
+        uint e2 = elementPairs[uint(i)].second;
+
+        if (!RLimitBox::areIntersecting(limitBoxes[e1],limitBoxes[e2]))
         {
-            if (omp_get_thread_num() == 0)
-            {
-                RProgressPrint(n_count.load(), n_total);
-            }
+            continue;
         }
 
-        for (int64_t j=i+1;j<int64_t(this->getNElements());j++)
+        QList<RR3Vector> x;
+        if (RElement::findIntersectionPoints(this->getElement(e1),this->getElement(e2),this->getNodes(),x,true))
         {
-            n_count.fetch_add(1, std::memory_order_relaxed);
-            if ((intElements[i] && intElements[j]) || !RLimitBox::areIntersecting(limitBoxes[i],limitBoxes[j]))
-            {
-                continue;
-            }
-
-            QList<RR3Vector> x;
-            if (RElement::findIntersectionPoints(this->getElement(i),this->getElement(uint(j)),this->getNodes(),x,true))
-            {
-#pragma omp critical
-                {
-                    intElements[i] = true;
-                    intElements[j] = true;
-                }
-            }
+            std::vector<uint> &elementIDs = threadElementIDs[uint(omp_get_thread_num())];
+            elementIDs.push_back(e1);
+            elementIDs.push_back(e2);
         }
     }
     RProgressFinalize("Done");
 
+    std::vector<bool> intElements(this->getNElements(),false);
+    for (uint i=0;i<threadElementIDs.size();i++)
+    {
+        for (uint j=0;j<threadElementIDs[i].size();j++)
+        {
+            intElements[threadElementIDs[i][j]] = true;
+        }
+    }
+
     uint nIntersected = 0;
-    for (int i=0;i<intElements.size();i++)
+    for (uint i=0;i<intElements.size();i++)
     {
         if (intElements[i])
         {
@@ -5385,11 +6042,11 @@ QList<uint> RModel::findIntersectedElements() const
     QList<uint> elementIDs;
     elementIDs.reserve(int(nIntersected));
 
-    for (int i=0;i<intElements.size();i++)
+    for (uint i=0;i<intElements.size();i++)
     {
         if (intElements[i])
         {
-            elementIDs.append(uint(i));
+            elementIDs.append(i);
         }
     }
 
@@ -5422,6 +6079,10 @@ uint RModel::breakIntersectedElements(uint nIterations, const std::vector<uint>
 
     std::vector<uint> bElementIDs(elementIDs);
 
+    // Broad phase tree is refitted and extended with new elements in each iteration.
+    RElementTree elementTree;
+    uint nTreeElements = 0;
+
     while (iteration < nIterations)
     {
         bool intersectionFound = false;
@@ -5433,11 +6094,43 @@ uint RModel::breakIntersectedElements(uint nIterations, const std::vector<uint>
         std::vector< QList<RR3Vector> > intersectionPoints;
         intersectionPoints.resize(bElementIDs.size());
 
-        QVector<RLimitBox> limitBoxes(bElementIDs.size());
+        std::vector<RLimitBox> limitBoxes(bElementIDs.size());
+#pragma omp parallel for default(shared)
+        for (int64_t i=0;i<int64_t(bElementIDs.size());i++)
+        {
+            this->getElement(bElementIDs[uint(i)]).findLimitBox(this->getNodes(),limitBoxes[uint(i)]);
+        }
+
+        std::vector<uint> elementPositions(this->getNElements(),RConstants::eod);
         for (uint i=0;i<bElementIDs.size();i++)
         {
-            this->getElement(bElementIDs[i]).findLimitBox(this->getNodes(),limitBoxes[i]);
+            elementPositions[bElementIDs[i]] = i;
+        }
+
+        // Find candidate pairs.
+        RLogger::info("Finding candidate element pairs\n");
+        if (nTreeElements == 0)
+        {
+            elementTree.build(this->getNodes(),this->getElements(),bElementIDs);
+        }
+        else
+        {
+            elementTree.refit(this->getNodes(),this->getElements());
+            elementTree.insert(this->getNodes(),this->getElements(),std::vector<uint>(bElementIDs.begin()+nTreeElements,bElementIDs.end()));
+        }
+        nTreeElements = uint(bElementIDs.size());
+
+        std::vector< std::pair<uint,uint> > elementPairs;
+        elementTree.findElementPairs(elementPairs);
+        for (uint i=0;i<elementPairs.size();i++)
+        {
+            uint p1 = elementPositions[elementPairs[i].first];
+            uint p2 = elementPositions[elementPairs[i].second];
+            elementPairs[i].first = std::min(p1,p2);
+            elementPairs[i].second = std::max(p1,p2);
         }
+        // Process pairs in the same order as if all pairs of positions were tested one after the other.
+        std::sort(elementPairs.begin(),elementPairs.end());
 
         // Find intersection points.
         RLogger::info("Finding intersection points\n");
@@ -5446,69 +6139,92 @@ uint RModel::breakIntersectedElements(uint nIterations, const std::vector<uint>
         RProgressPrintToLog(false);
         RProgressInitialize("Finding intersection points");
 
-        for (uint i=0;i<bElementIDs.size();i++)
+        // Each thread stores found intersections (pair position and points) in to its own buffer.
+        std::vector< std::vector< std::pair< uint,QList<RR3Vector> > > > threadIntersections(uint(omp_get_max_threads()));
+
+        const uint64_t n_total = uint64_t(elementPairs.size());
+        std::atomic<uint64_t> n_count(0);
+#pragma omp parallel for schedule(dynamic,256) default(shared)
+        for (int64_t i=0;i<int64_t(elementPairs.size());i++)
         {
-            RProgressPrint(i,uint(bElementIDs.size()));
+            uint64_t count = n_count.fetch_add(1, std::memory_order_relaxed);
+            if ((count % 1000) == 0 && omp_get_thread_num() == 0)
+            {
+                RProgressPrint(count, n_total);
+            }
 
-            if (this->getElement(bElementIDs[i]).hasDuplicateNodes())
+            uint p1 = elementPairs[uint(i)].first;
+            uint p2 = elementPairs[uint(i)].second;
+
+            if (this->getElement(bElementIDs[p1]).hasDuplicateNodes() ||
+                this->getElement(bElementIDs[p2]).hasDuplicateNodes())
             {
                 continue;
             }
 
-#pragma omp parallel for default(shared)
-            for (int64_t j=int64_t(i)+1;j<int64_t(bElementIDs.size());j++)
+            if (!RLimitBox::areIntersecting(limitBoxes[p1],limitBoxes[p2]))
             {
-                if (this->getElement(bElementIDs[uint(j)]).hasDuplicateNodes())
+                continue;
+            }
+
+            QList<RR3Vector> x;
+            if (RElement::findIntersectionPoints(this->getElement(bElementIDs[p1]),this->getElement(bElementIDs[p2]),this->getNodes(),x))
+            {
+                threadIntersections[uint(omp_get_thread_num())].push_back(std::pair< uint,QList<RR3Vector> >(uint(i),x));
+            }
+        }
+
+        // Merge thread buffers in pair order.
+        std::vector< std::pair< uint,QList<RR3Vector> > > intersections;
+        for (uint i=0;i<threadIntersections.size();i++)
+        {
+            intersections.insert(intersections.end(),threadIntersections[i].begin(),threadIntersections[i].end());
+            threadIntersections[i].clear();
+        }
+        std::sort(intersections.begin(),intersections.end(),[](const std::pair< uint,QList<RR3Vector> > &a, const std::pair< uint,QList<RR3Vector> > &b)
+        {
+            return a.first < b.first;
+        });
+
+        for (uint k=0;k<intersections.size();k++)
+        {
+            uint i = elementPairs[intersections[k].first].first;
+            uint j = elementPairs[intersections[k].first].second;
+            const QList<RR3Vector> &x = intersections[k].second;
+
+            QList<RR3Vector>::const_reverse_iterator it;
+            for (it=x.crbegin();it!=x.crend();++it)
+            {
+                // Insert only nodes which are not in the verticies.
+                bool nodeFound = false;
+                QList<RR3Vector>::const_iterator cit;
+                for (cit=intersectionPoints[i].constBegin();cit!=intersectionPoints[i].constEnd();++cit)
                 {
-                    continue;
+                    if (RR3Vector::findDistance(*it,*cit) < tolerance)
+                    {
+                        nodeFound = true;
+                        break;
+                    }
                 }
-
-                if (!RLimitBox::areIntersecting(limitBoxes[i],limitBoxes[j]))
+                if (!nodeFound)
                 {
-                    continue;
+                    intersectionPoints[i].append(*it);
+                    intersectionFound = true;
                 }
-
-                QList<RR3Vector> x;
-                if (RElement::findIntersectionPoints(this->getElement(bElementIDs[i]),this->getElement(bElementIDs[uint(j)]),this->getNodes(),x))
+                nodeFound = false;
+                for (cit=intersectionPoints[j].constBegin();cit!=intersectionPoints[j].constEnd();++cit)
                 {
-#pragma omp critical
+                    if (RR3Vector::findDistance(*it,*cit) < tolerance)
                     {
-                        QList<RR3Vector>::reverse_iterator it;
-                        for (it=x.rbegin();it!=x.rend();++it)
-                        {
-                            // Insert only nodes which are not in the verticies.
-                            bool nodeFound = false;
-                            QList<RR3Vector>::const_iterator cit;
-                            for (cit=intersectionPoints[i].constBegin();cit!=intersectionPoints[i].constEnd();++cit)
-                            {
-                                if (RR3Vector::findDistance(*it,*cit) < tolerance)
-                                {
-                                    nodeFound = true;
-                                    break;
-                                }
-                            }
-                            if (!nodeFound)
-                            {
-                                intersectionPoints[i].append(*it);
-                                intersectionFound = true;
-                            }
-                            nodeFound = false;
-                            for (cit=intersectionPoints[uint(j)].constBegin();cit!=intersectionPoints[uint(j)].constEnd();++cit)
-                            {
-                                if (RR3Vector::findDistance(*it,*cit) < tolerance)
-                                {
-                                    nodeFound = true;
-                                    break;
-                                }
-                            }
-                            if (!nodeFound)
-                            {
-                                intersectionPoints[uint(j)].append(*it);
-                                intersectionFound = true;
-                            }
-                        }
+                        nodeFound = true;
+                        break;
                     }
                 }
+                if (!nodeFound)
+                {
+                    intersectionPoints[j].append(*it);
+                    intersectionFound = true;
+                }
             }
         }
 
@@ -5613,16 +6329,24 @@ uint RModel::breakIntersectedElements(uint nIterations, const std::vector<uint>
         // Merge near/duplicate nodes.
         RLogger::info("Merging near/duplicate nodes\n");
         RLogger::indent();
-        uint nMerged = 0;
-        for (uint i=this->getNNodes()-1;i>=oldNNodes;i--)
+        std::vector<uint> mergeMap(this->getNNodes());
+        RNodeGrid nodeGrid(tolerance,RNodeGrid::findCellSize(this->getNodes(),tolerance));
+        nodeGrid.reserve(this->getNNodes());
+        for (uint i=0;i<this->getNNodes();i++)
         {
-            uint nId = this->findNearNode(this->getNode(i),tolerance,false,i);
-            if (nId != RConstants::eod)
+            mergeMap[i] = i;
+            if (i >= oldNNodes)
             {
-                this->mergeNodes(nId,i,false,false);
-                nMerged ++;
+                uint nId = nodeGrid.findNearNode(this->getNodes(),this->getNode(i),false,true);
+                if (nId != RConstants::eod)
+                {
+                    mergeMap[i] = nId;
+                    continue;
+                }
             }
+            nodeGrid.insert(this->getNode(i),i);
         }
+        uint nMerged = this->mergeNodes(mergeMap,false);
         RLogger::info("Merged near/duplicate nodes = %u\n",nMerged);
         RLogger::unindent();
 
@@ -5630,22 +6354,22 @@ uint RModel::breakIntersectedElements(uint nIterations, const std::vector<uint>
         RLogger::info("Removing duplicate elements\n");
         RLogger::indent();
 
+        std::vector<uint> dElementIDs;
+        dElementIDs.reserve(bElementIDs.size());
         for (uint i=0;i<bElementIDs.size();i++)
         {
-            const RElement &rElement1 = this->getElement(bElementIDs[i]);
-            if (rElement1.hasDuplicateNodes())
+            if (!this->getElement(bElementIDs[i]).hasDuplicateNodes())
             {
-                continue;
-            }
-            for (uint j=i+1;j<bElementIDs.size();j++)
-            {
-                RElement &rElement2 = this->getElement(bElementIDs[j]);
-                if (rElement1 == rElement2)
-                {
-                    rElement2.setNodeId(1,rElement2.getNodeId(0));
-                }
+                dElementIDs.push_back(bElementIDs[i]);
             }
         }
+        dElementIDs = this->findDuplicateElements(dElementIDs);
+        for (uint i=0;i<dElementIDs.size();i++)
+        {
+            RElement &rElement = this->elements[dElementIDs[i]];
+            rElement.setNodeId(1,rElement.getNodeId(0));
+        }
+        this->setMeshModified();
 
         RLogger::unindent();
 
@@ -6120,6 +6844,8 @@ uint RModel::tetrahedralizeSurface(const std::vector<uint> surfaceIDs)
     {
         this->nodes[nNodes + i] = steinerNodes[i];
     }
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
 
     // Add tetrahedrons to volume.
     for (uint i=0;i<volumeElements.size();i++)
@@ -6166,9 +6892,11 @@ RRVector RModel::generateMeshSizeFunction(const QSet<RVariableType> variableType
             {
                 continue;
             }
-            for (uint i=0;i<rVariable.getNValues();i++)
+            const RRVector &values = rVariable.getMagnitudes();
+#pragma omp parallel for default(shared)
+            for (int64_t i=0;i<int64_t(values.size());i++)
             {
-                nodeValues[i] = (rVariable.getValue(i) - minValue) / magValue;
+                nodeValues[uint(i)] = (values[uint(i)] - minValue) / magValue;
             }
         }
         else
@@ -6196,10 +6924,11 @@ RRVector RModel::generateMeshSizeFunction(const QSet<RVariableType> variableType
             {
                 continue;
             }
+            const RRVector &values = newVariable.getMagnitudes();
 #pragma omp parallel for default(shared)
-            for (int64_t i=0;i<int64_t(newVariable.getNValues());i++)
+            for (int64_t i=0;i<int64_t(values.size());i++)
             {
-                nodeValues[uint(i)] = (newVariable.getValue(uint(i)) - minValue) / magValue;
+                nodeValues[uint(i)] = (values[uint(i)] - minValue) / magValue;
             }
         }
 
@@ -7163,6 +7892,74 @@ QString RModel::getDefaultFileExtension(bool binary)
 } /* RModel::getDefaultFileExtension */
 
 
+QByteArray RModel::findMeshHash() const
+{
+    QByteArray connectivityHash = this->findConnectivityHash();
+    uint64_t revision = this->getMeshRevision();
+    QByteArray meshHash;
+
+#pragma omp critical (RModelMeshHash)
+    {
+        if (this->meshHashRevision != revision)
+        {
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+
+            std::vector<double> nodeBuffer(3*this->nodes.size());
+            for (uint i=0;i<this->nodes.size();i++)
+            {
+                nodeBuffer[3*i+0] = this->nodes[i].getX();
+                nodeBuffer[3*i+1] = this->nodes[i].getY();
+                nodeBuffer[3*i+2] = this->nodes[i].getZ();
+            }
+            qToLittleEndian<double>(nodeBuffer.data(),qsizetype(nodeBuffer.size()),nodeBuffer.data());
+            hash.addData(QByteArray::fromRawData((const char*)nodeBuffer.data(),qsizetype(nodeBuffer.size()*sizeof(double))));
+            hash.addData(connectivityHash);
+
+            this->meshHash = hash.result();
+            this->meshHashRevision = revision;
+        }
+        meshHash = this->meshHash;
+    }
+
+    return meshHash;
+} /* RModel::findMeshHash */
+
+
+QByteArray RModel::findConnectivityHash() const
+{
+    uint64_t revision = this->getMeshRevision();
+    QByteArray connectivityHash;
+
+#pragma omp critical (RModelConnectivityHash)
+    {
+        if (this->connectivityHashRevision != revision)
+        {
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+
+            std::vector<uint> elementBuffer;
+            elementBuffer.reserve(4*this->elements.size());
+            for (uint i=0;i<this->elements.size();i++)
+            {
+                const RElement &rElement = this->elements[i];
+                elementBuffer.push_back(uint(rElement.getType()));
+                for (uint j=0;j<rElement.size();j++)
+                {
+                    elementBuffer.push_back(rElement.getNodeId(j));
+                }
+            }
+            qToLittleEndian<uint>(elementBuffer.data(),qsizetype(elementBuffer.size()),elementBuffer.data());
+            hash.addData(QByteArray::fromRawData((const char*)elementBuffer.data(),qsizetype(elementBuffer.size()*sizeof(uint))));
+
+            this->connectivityHash = hash.result();
+            this->connectivityHashRevision = revision;
+        }
+        connectivityHash = this->connectivityHash;
+    }
+
+    return connectivityHash;
+} /* RModel::findConnectivityHash */
+
+
 void RModel::writeLink(const QString &linkFileName, const QString &targetFileName)
 {
     if (linkFileName.isEmpty() || targetFileName.isEmpty())
@@ -7229,6 +8026,11 @@ QString RModel::readAscii(const QString &fileName)
     // Set file version
     modelFile.setVersion(fileHeader.getVersion());
 
+    // Mesh is replaced, results files sharing already loaded mesh keep search structures and hashes.
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
+    this->neighborsPending.store(false,std::memory_order_release);
+
     // Reading mesh/model values
 
     RFileIO::readAscii(modelFile,this->name);
@@ -7239,17 +8041,82 @@ QString RModel::readAscii(const QString &fileName)
     RFileIO::readAscii(modelFile,nNodes);
     RLogger::debug("Nodes: %u\n",nNodes);
     this->nodes.resize(nNodes);
-    for (uint i=0;i<nNodes;i++)
+    // Each node is stored on separate line which allows parallel parsing.
+    bool nodesParsed = RAsciiParser::parseLines(modelFile,nNodes,[this](const char *lineBegin, const char *lineEnd, uint lineID)
+    {
+        double x, y, z;
+        if (!RAsciiParser::parseDouble(lineBegin,lineEnd,x) ||
+            !RAsciiParser::parseDouble(lineBegin,lineEnd,y) ||
+            !RAsciiParser::parseDouble(lineBegin,lineEnd,z) ||
+            !RAsciiParser::isBlank(lineBegin,lineEnd))
+        {
+            return false;
+        }
+        this->nodes[lineID].set(x,y,z);
+        return true;
+    });
+    if (!nodesParsed)
     {
-        RFileIO::readAscii(modelFile,this->nodes[i]);
+        for (uint i=0;i<nNodes;i++)
+        {
+            RFileIO::readAscii(modelFile,this->nodes[i]);
+        }
     }
     uint nElements = 0;
     RFileIO::readAscii(modelFile,nElements);
     RLogger::debug("Elements: %u\n",nElements);
     this->elements.resize(nElements);
-    for (uint i=0;i<nElements;i++)
+    // Each element is stored on separate line which allows parallel parsing.
+    std::vector<QByteArray> elementTypeIds(R_ELEMENT_N_TYPES);
+    for (uint type=uint(R_ELEMENT_NONE);type<uint(R_ELEMENT_N_TYPES);type++)
+    {
+        elementTypeIds[type] = RElement::getId(RElementType(type)).toUtf8();
+    }
+    bool elementsParsed = RAsciiParser::parseLines(modelFile,nElements,[this,&elementTypeIds](const char *lineBegin, const char *lineEnd, uint lineID)
+    {
+        const char *tokenBegin = nullptr;
+        const char *tokenEnd = nullptr;
+        if (!RAsciiParser::findToken(lineBegin,lineEnd,tokenBegin,tokenEnd))
+        {
+            return false;
+        }
+        if (tokenEnd - tokenBegin >= 2 && *tokenBegin == '"' && *(tokenEnd-1) == '"')
+        {
+            tokenBegin++;
+            tokenEnd--;
+        }
+        QByteArray typeId(tokenBegin,int(tokenEnd - tokenBegin));
+        uint type = 0;
+        while (type < elementTypeIds.size() && elementTypeIds[type] != typeId)
+        {
+            type++;
+        }
+        uint nNodeIDs = 0;
+        if (type == elementTypeIds.size() ||
+            !RAsciiParser::parseUInt(lineBegin,lineEnd,nNodeIDs) ||
+            nNodeIDs != RElement::getNNodes(RElementType(type)))
+        {
+            return false;
+        }
+        RElement &rElement = this->elements[lineID];
+        rElement.setType(RElementType(type));
+        for (uint i=0;i<nNodeIDs;i++)
+        {
+            uint nodeID = 0;
+            if (!RAsciiParser::parseUInt(lineBegin,lineEnd,nodeID))
+            {
+                return false;
+            }
+            rElement.setNodeId(i,nodeID);
+        }
+        return RAsciiParser::isBlank(lineBegin,lineEnd);
+    });
+    if (!elementsParsed)
     {
-        RFileIO::readAscii(modelFile,this->elements[i]);
+        for (uint i=0;i<nElements;i++)
+        {
+            RFileIO::readAscii(modelFile,this->elements[i]);
+        }
     }
     uint nPoints = 0;
     RFileIO::readAscii(modelFile,nPoints);
@@ -7352,6 +8219,7 @@ QString RModel::readAscii(const QString &fileName)
     uint nVariables = 0;
     RFileIO::readAscii(modelFile,nVariables);
     RLogger::debug("variables: %u\n",nVariables);
+    this->RResults::removeAllVariables();
     this->RResults::variables.resize(nVariables);
     for (uint i=0;i<this->RResults::variables.size();i++)
     {
@@ -7382,7 +8250,7 @@ QString RModel::readAscii(const QString &fileName)
 } /* RModel::readAscii */
 
 
-QString RModel::readBinary(const QString &fileName)
+QString RModel::readBinary(const QString &fileName, bool loadVariablesOnDemand)
 {
     if (fileName.isEmpty())
     {
@@ -7409,6 +8277,14 @@ QString RModel::readBinary(const QString &fileName)
         RLogger::info("File \'%s\' is a link file pointing to \'%s\'\n",fileName.toUtf8().constData(),targetFileName.toUtf8().constData());
         return targetFileName;
     }
+    if (fileHeader.getType() == R_FILE_TYPE_RESULTS)
+    {
+        modelFile.setVersion(fileHeader.getVersion());
+        QString baseFileName(RFileManager::findLinkTargetFileName(fileName,fileHeader.getInformation()));
+        RLogger::info("File \'%s\' is a results file based on \'%s\'\n",fileName.toUtf8().constData(),baseFileName.toUtf8().constData());
+        this->readBinaryResults(modelFile,fileName,baseFileName,loadVariablesOnDemand);
+        return QString();
+    }
     if (fileHeader.getType() != R_FILE_TYPE_MODEL)
     {
         throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"File type of the file \'" + fileName + "\' is not MODEL.");
@@ -7421,27 +8297,52 @@ QString RModel::readBinary(const QString &fileName)
     // Set file version
     modelFile.setVersion(fileHeader.getVersion());
 
+    if (RFileIO::isBlockLayoutVersion(modelFile.getVersion()))
+    {
+        // Section index is not needed for sequential reading.
+        std::vector<qsizetype> sectionOffsets;
+        RFileIO::readBinary(modelFile,sectionOffsets);
+        std::vector<qsizetype> variableOffsets;
+        RFileIO::readBinary(modelFile,variableOffsets);
+    }
+
+    // Mesh is replaced, results files sharing already loaded mesh keep search structures and hashes.
+    this->invalidateElementTree();
+    this->invalidateNodeIncidence();
+    this->neighborsPending.store(false,std::memory_order_release);
+
     // Reading mesh/model values
 
     RFileIO::readBinary(modelFile,this->name);
     RLogger::debug("Name: '%s'\n",this->name.toUtf8().constData());
     RFileIO::readBinary(modelFile,this->description);
     RLogger::debug("Description: '%s'\n",this->description.toUtf8().constData());
-    uint nNodes = 0;
-    RFileIO::readBinary(modelFile,nNodes);
-    RLogger::debug("Nodes: %u\n",nNodes);
-    this->nodes.resize(nNodes);
-    for (uint i=0;i<nNodes;i++)
+    if (RFileIO::isBlockLayoutVersion(modelFile.getVersion()))
     {
-        RFileIO::readBinary(modelFile,this->nodes[i]);
+        // Nodes and elements are stored in contiguous blocks.
+        RFileIO::readBinaryBlock(modelFile,this->nodes);
+        RLogger::debug("Nodes: %u\n",this->getNNodes());
+        RFileIO::readBinaryBlock(modelFile,this->elements);
+        RLogger::debug("Elements: %u\n",this->getNElements());
     }
-    uint nElements = 0;
-    RFileIO::readBinary(modelFile,nElements);
-    RLogger::debug("Elements: %u\n",nElements);
-    this->elements.resize(nElements);
-    for (uint i=0;i<nElements;i++)
+    else
     {
-        RFileIO::readBinary(modelFile,this->elements[i]);
+        uint nNodes = 0;
+        RFileIO::readBinary(modelFile,nNodes);
+        RLogger::debug("Nodes: %u\n",nNodes);
+        this->nodes.resize(nNodes);
+        for (uint i=0;i<nNodes;i++)
+        {
+            RFileIO::readBinary(modelFile,this->nodes[i]);
+        }
+        uint nElements = 0;
+        RFileIO::readBinary(modelFile,nElements);
+        RLogger::debug("Elements: %u\n",nElements);
+        this->elements.resize(nElements);
+        for (uint i=0;i<nElements;i++)
+        {
+            RFileIO::readBinary(modelFile,this->elements[i]);
+        }
     }
     uint nPoints = 0;
     RFileIO::readBinary(modelFile,nPoints);
@@ -7544,28 +8445,65 @@ QString RModel::readBinary(const QString &fileName)
     uint nVariables = 0;
     RFileIO::readBinary(modelFile,nVariables);
     RLogger::debug("variables: %u\n",nVariables);
+    this->RResults::removeAllVariables();
     this->RResults::variables.resize(nVariables);
-    for (uint i=0;i<this->RResults::variables.size();i++)
+    if (loadVariablesOnDemand)
+    {
+        // Only variable headers are read, values are loaded on first access.
+        std::vector<qint64> variableOffsets(nVariables);
+        for (uint i=0;i<this->RResults::variables.size();i++)
+        {
+            variableOffsets[i] = modelFile.pos();
+            RFileIO::readBinaryHeader(modelFile,this->RResults::variables[i]);
+        }
+        this->RResults::setDeferredVariables(fileName,modelFile.getVersion(),variableOffsets);
+    }
+    else
     {
-        RFileIO::readBinary(modelFile,this->RResults::variables[i]);
+        for (uint i=0;i<this->RResults::variables.size();i++)
+        {
+            RFileIO::readBinary(modelFile,this->RResults::variables[i]);
+        }
     }
 
     // Reading neighbor information.
-    uint nSurfaceNeigs = 0;
-    RFileIO::readBinary(modelFile,nSurfaceNeigs);
-    RLogger::debug("Surface neighbors: %u\n",nSurfaceNeigs);
-    this->surfaceNeigs.resize(nSurfaceNeigs);
-    for (uint i=0;i<this->surfaceNeigs.size();i++)
+    if (RFileIO::isBlockLayoutVersion(modelFile.getVersion()))
     {
-        RFileIO::readBinary(modelFile,this->surfaceNeigs[i]);
+        QByteArray connectivityHash;
+        RFileIO::readBinary(modelFile,connectivityHash);
+        RFileIO::readBinaryBlock(modelFile,this->surfaceNeigs);
+        RLogger::debug("Surface neighbors: %u\n",this->surfaceNeigs.size());
+        RFileIO::readBinaryBlock(modelFile,this->volumeNeigs);
+        RLogger::debug("Volume neighbors: %u\n",this->volumeNeigs.size());
+        if (connectivityHash != this->findConnectivityHash())
+        {
+            RLogger::warning("Stored element neighbors do not match the mesh and will be recalculated.\n");
+            this->surfaceNeigs.clear();
+            this->volumeNeigs.clear();
+        }
+        // Empty table marks neighbors which were not available when file was written,
+        // missing tables are calculated on first access.
+        this->neighborsPending.store(this->surfaceNeigs.size() != this->getNElements() ||
+                                     this->volumeNeigs.size() != this->getNElements(),std::memory_order_release);
     }
-    uint nVolumeNeigs = 0;
-    RFileIO::readBinary(modelFile,nVolumeNeigs);
-    RLogger::debug("Volume neighbors: %u\n",nVolumeNeigs);
-    this->volumeNeigs.resize(nVolumeNeigs);
-    for (uint i=0;i<this->volumeNeigs.size();i++)
+    else
     {
-        RFileIO::readBinary(modelFile,this->volumeNeigs[i]);
+        uint nSurfaceNeigs = 0;
+        RFileIO::readBinary(modelFile,nSurfaceNeigs);
+        RLogger::debug("Surface neighbors: %u\n",nSurfaceNeigs);
+        this->surfaceNeigs.resize(nSurfaceNeigs);
+        for (uint i=0;i<this->surfaceNeigs.size();i++)
+        {
+            RFileIO::readBinary(modelFile,this->surfaceNeigs[i]);
+        }
+        uint nVolumeNeigs = 0;
+        RFileIO::readBinary(modelFile,nVolumeNeigs);
+        RLogger::debug("Volume neighbors: %u\n",nVolumeNeigs);
+        this->volumeNeigs.resize(nVolumeNeigs);
+        for (uint i=0;i<this->volumeNeigs.size();i++)
+        {
+            RFileIO::readBinary(modelFile,this->volumeNeigs[i]);
+        }
     }
 
     modelFile.close();
@@ -7726,6 +8664,7 @@ void RModel::writeAscii(const QString &fileName) const
     RFileIO::writeAscii(modelFile,this->RResults::nnodes);
     RLogger::debug("Results elements: %u\n",this->RResults::nelements);
     RFileIO::writeAscii(modelFile,this->RResults::nelements);
+    this->RResults::loadVariables();
     RLogger::debug("variables: %u\n",this->RResults::variables.size());
     RFileIO::writeAscii(modelFile,uint(this->RResults::variables.size()));
     for (uint i=0;i<this->RResults::variables.size();i++)
@@ -7788,26 +8727,31 @@ void RModel::writeBinary(const QString &fileName) const
     RLogger::debug("File header: %s\n",fileHeader.toString().toUtf8().constData());
     RFileIO::writeBinary(modelFile,fileHeader);
 
+    this->RResults::loadVariables();
+
+    // Section index is written with zero offsets and filled once all sections are written.
+    qint64 indexPosition = modelFile.pos();
+    std::vector<qsizetype> sectionOffsets(R_MODEL_FILE_N_SECTIONS,0);
+    std::vector<qsizetype> variableOffsets(this->RResults::variables.size(),0);
+    RFileIO::writeBinary(modelFile,sectionOffsets);
+    RFileIO::writeBinary(modelFile,variableOffsets);
+
     // Writing mesh/model values
 
+    sectionOffsets[R_MODEL_FILE_SECTION_MESH] = modelFile.pos();
     RLogger::debug("Name: '%s'\n",this->name.toUtf8().constData());
     RFileIO::writeBinary(modelFile,this->name);
     RLogger::debug("Description: '%s'\n",this->description.toUtf8().constData());
     RFileIO::writeBinary(modelFile,this->description);
     RLogger::debug("Nodes: %u\n",this->getNNodes());
-    RFileIO::writeBinary(modelFile,this->getNNodes());
-    for (uint i=0;i<this->getNNodes();i++)
-    {
-        RProgressPrint(cstep++,nsteps);
-        RFileIO::writeBinary(modelFile,this->nodes[i]);
-    }
+    RFileIO::writeBinaryBlock(modelFile,this->nodes);
+    cstep += this->getNNodes();
+    RProgressPrint(cstep,nsteps);
     RLogger::debug("Elements: %u\n",this->getNElements());
-    RFileIO::writeBinary(modelFile,this->getNElements());
-    for (uint i=0;i<this->getNElements();i++)
-    {
-        RProgressPrint(cstep++,nsteps);
-        RFileIO::writeBinary(modelFile,this->elements[i]);
-    }
+    RFileIO::writeBinaryBlock(modelFile,this->elements);
+    cstep += this->getNElements();
+    RProgressPrint(cstep,nsteps);
+    sectionOffsets[R_MODEL_FILE_SECTION_ENTITY_GROUPS] = modelFile.pos();
     RLogger::debug("Points: %u\n",this->getNPoints());
     RFileIO::writeBinary(modelFile,this->getNPoints());
     for (uint i=0;i<this->getNPoints();i++)
@@ -7836,6 +8780,7 @@ void RModel::writeBinary(const QString &fileName) const
         RProgressPrint(cstep++,nsteps);
         RFileIO::writeBinary(modelFile,this->volumes[i]);
     }
+    sectionOffsets[R_MODEL_FILE_SECTION_INTERPOLATED_ENTITIES] = modelFile.pos();
     RLogger::debug("Vector fields: %u\n",this->getNVectorFields());
     RFileIO::writeBinary(modelFile,this->getNVectorFields());
     for (uint i=0;i<this->getNVectorFields();i++)
@@ -7871,10 +8816,12 @@ void RModel::writeBinary(const QString &fileName) const
         RProgressPrint(cstep++,nsteps);
         RFileIO::writeBinary(modelFile,this->isos[i]);
     }
+    sectionOffsets[R_MODEL_FILE_SECTION_MODEL_DATA] = modelFile.pos();
     RFileIO::writeBinary(modelFile,this->modelData);
 
     // Writing problem values
 
+    sectionOffsets[R_MODEL_FILE_SECTION_PROBLEM] = modelFile.pos();
     RLogger::debug("Task tree ...\n");
     RFileIO::writeBinary(modelFile,this->taskTree);
     RLogger::debug("Time solver ...\n");
@@ -7890,6 +8837,7 @@ void RModel::writeBinary(const QString &fileName) const
 
     // Writing results values
 
+    sectionOffsets[R_MODEL_FILE_SECTION_RESULTS] = modelFile.pos();
     RLogger::debug("Results nodes: %u\n",this->RResults::nnodes);
     RFileIO::writeBinary(modelFile,this->RResults::nnodes);
     RLogger::debug("Results elements: %u\n",this->RResults::nelements);
@@ -7898,22 +8846,27 @@ void RModel::writeBinary(const QString &fileName) const
     RFileIO::writeBinary(modelFile,uint(this->RResults::variables.size()));
     for (uint i=0;i<this->RResults::variables.size();i++)
     {
+        variableOffsets[i] = modelFile.pos();
         RFileIO::writeBinary(modelFile,this->RResults::variables[i]);
     }
 
     // Writing neighbor information.
+    // Missing neighbor tables are written empty and computed once after reading.
+    sectionOffsets[R_MODEL_FILE_SECTION_NEIGHBORS] = modelFile.pos();
+    RFileIO::writeBinary(modelFile,this->findConnectivityHash());
+    std::vector<RUVector> missingNeigs;
     RLogger::debug("Surface neighbors: %u\n",this->surfaceNeigs.size());
-    RFileIO::writeBinary(modelFile,uint(this->surfaceNeigs.size()));
-    for (uint i=0;i<this->surfaceNeigs.size();i++)
-    {
-        RFileIO::writeBinary(modelFile,this->surfaceNeigs[i]);
-    }
+    RFileIO::writeBinaryBlock(modelFile,(this->surfaceNeigs.size() == this->getNElements()) ? this->surfaceNeigs : missingNeigs);
     RLogger::debug("Volume neighbors: %u\n",this->volumeNeigs.size());
-    RFileIO::writeBinary(modelFile,uint(this->volumeNeigs.size()));
-    for (uint i=0;i<this->volumeNeigs.size();i++)
+    RFileIO::writeBinaryBlock(modelFile,(this->volumeNeigs.size() == this->getNElements()) ? this->volumeNeigs : missingNeigs);
+
+    // Writing section index.
+    if (!modelFile.seek(indexPosition))
     {
-        RFileIO::writeBinary(modelFile,this->volumeNeigs[i]);
+        throw RError(RError::Type::WriteFile,R_ERROR_REF,"Failed to write section index to the file \'%s\'.",fileName.toUtf8().constData());
     }
+    RFileIO::writeBinary(modelFile,sectionOffsets);
+    RFileIO::writeBinary(modelFile,variableOffsets);
 
     modelFile.commit();
 
@@ -7921,146 +8874,286 @@ void RModel::writeBinary(const QString &fileName) const
 } /* RModel::writeBinary */
 
 
-std::vector<RUVector> RModel::findSurfaceNeighbors() const
+void RModel::readBinaryResults(RFile &modelFile, const QString &fileName, const QString &baseFileName, bool loadVariablesOnDemand)
 {
-    std::vector<RUVector> neigs;
+    QByteArray meshHash;
+    RFileIO::readBinary(modelFile,meshHash);
 
-    RLogger::info("Finding surface neighbors\n");
-    RLogger::indent();
-    RProgressInitialize("Finding surface neighbors");
+    // Consecutive results files usually share the base which is then already loaded.
+    if (this->findMeshHash() != meshHash)
+    {
+        // Base must be a model file, link or results file could lead back to this file.
+        bool binaryBase = (RFileManager::getExtension(baseFileName) == RModel::getDefaultFileExtension(true));
+        RFile baseFile(baseFileName,binaryBase ? RFile::BINARY : RFile::ASCII);
+        if (!baseFile.open(binaryBase ? QIODevice::ReadOnly : (QIODevice::ReadOnly | QIODevice::Text)))
+        {
+            throw RError(RError::Type::OpenFile,R_ERROR_REF,"Failed to open the file \'%s\'.",baseFileName.toUtf8().constData());
+        }
+        RFileHeader baseFileHeader;
+        if (binaryBase)
+        {
+            RFileIO::readBinary(baseFile,baseFileHeader);
+        }
+        else
+        {
+            RFileIO::readAscii(baseFile,baseFileHeader);
+        }
+        baseFile.close();
+        if (baseFileHeader.getType() != R_FILE_TYPE_MODEL)
+        {
+            throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"Base file \'%s\' of the results file \'%s\' is not a model file.",
+                         baseFileName.toUtf8().constData(),
+                         fileName.toUtf8().constData());
+        }
 
-    neigs.resize(this->getNElements());
+        this->read(baseFileName,loadVariablesOnDemand);
+        if (this->findMeshHash() != meshHash)
+        {
+            throw RError(RError::Type::InvalidFileFormat,R_ERROR_REF,"Mesh of the base file \'%s\' does not match the results file \'%s\'.",
+                         baseFileName.toUtf8().constData(),
+                         fileName.toUtf8().constData());
+        }
+    }
 
-    RUVector surfaceElements;
-    surfaceElements.reserve(this->getNElements());
-    for (uint i=0;i<this->getNElements();i++)
+    RFileIO::readBinary(modelFile,this->timeSolver);
+    RLogger::debug("Time solver ...\n");
+    RFileIO::readBinary(modelFile,this->problemSetup);
+    RLogger::debug("Problem setup: %s\n",problemSetup.toString().toUtf8().constData());
+
+    RFileIO::readBinary(modelFile,this->RResults::nnodes);
+    RLogger::debug("Results nodes: %u\n",this->RResults::nnodes);
+    RFileIO::readBinary(modelFile,this->RResults::nelements);
+    RLogger::debug("Results elements: %u\n",this->RResults::nelements);
+    uint nVariables = 0;
+    RFileIO::readBinary(modelFile,nVariables);
+    RLogger::debug("variables: %u\n",nVariables);
+    this->RResults::removeAllVariables();
+    this->RResults::variables.resize(nVariables);
+    if (loadVariablesOnDemand)
     {
-        if (R_ELEMENT_TYPE_IS_SURFACE(this->getElement(i).getType()))
+        std::vector<qint64> variableOffsets(nVariables);
+        for (uint i=0;i<this->RResults::variables.size();i++)
         {
-            surfaceElements.push_back(i);
-            neigs[i].reserve(RElement::getNNeighbors(this->getElement(i).getType()));
+            variableOffsets[i] = modelFile.pos();
+            RFileIO::readBinaryHeader(modelFile,this->RResults::variables[i]);
         }
+        this->RResults::setDeferredVariables(fileName,modelFile.getVersion(),variableOffsets);
     }
-
-    uint64_t nProcessed = 0;
-#pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(surfaceElements.size());i++)
+    else
     {
-        uint elementID1 = surfaceElements[i];
-#pragma omp critical
+        for (uint i=0;i<this->RResults::variables.size();i++)
         {
-            RProgressPrint(++nProcessed,surfaceElements.size());
+            RFileIO::readBinary(modelFile,this->RResults::variables[i]);
         }
-        RLimitBox lb1,lb2;
-        this->getElement(elementID1).findLimitBox(this->getNodes(),lb1);
+    }
 
-        for (uint j=uint(i+1);j<surfaceElements.size();j++)
-        {
-            uint elementID2 = surfaceElements[j];
-            this->getElement(elementID2).findLimitBox(this->getNodes(),lb2);
-            if (!RLimitBox::areIntersecting(lb1,lb2))
-            {
-                continue;
-            }
+    modelFile.close();
+} /* RModel::readBinaryResults */
 
-            if (this->getElement(elementID1).isNeighbor(this->getElement(elementID2)))
-            {
-#pragma omp critical
-                {
-                    neigs[elementID1].push_back(elementID2);
-                    neigs[elementID2].push_back(elementID1);
-                }
-            }
-        }
+
+void RModel::writeBinaryResults(const QString &fileName, const QString &baseFileName) const
+{
+    if (fileName.isEmpty() || baseFileName.isEmpty())
+    {
+        throw RError(RError::Type::InvalidFileName,R_ERROR_REF,"No file name was provided.");
     }
 
-    RProgressFinalize();
+    RLogger::info("Writing binary results file \'%s\'\n",fileName.toUtf8().constData());
+
+    // Find relative path.
+    QDir fileDir(QFileInfo(fileName).absoluteDir());
+    QString relativeBaseFileName(fileDir.relativeFilePath(baseFileName));
+
+    RSaveFile modelFile(fileName,RSaveFile::BINARY);
+
+    if (!modelFile.open(QIODevice::WriteOnly))
+    {
+        throw RError(RError::Type::OpenFile,R_ERROR_REF,"Failed to open the file \'%s\'.",fileName.toUtf8().constData());
+    }
+
+    RFileHeader fileHeader(R_FILE_TYPE_RESULTS,RModel::version,relativeBaseFileName);
+    RLogger::debug("File header: %s\n",fileHeader.toString().toUtf8().constData());
+    RFileIO::writeBinary(modelFile,fileHeader);
+
+    this->RResults::loadVariables();
+
+    RFileIO::writeBinary(modelFile,this->findMeshHash());
+
+    RLogger::debug("Time solver ...\n");
+    RFileIO::writeBinary(modelFile,this->timeSolver);
+    RLogger::debug("Problem setup: %s\n",problemSetup.toString().toUtf8().constData());
+    RFileIO::writeBinary(modelFile,this->problemSetup);
+
+    RLogger::debug("Results nodes: %u\n",this->RResults::nnodes);
+    RFileIO::writeBinary(modelFile,this->RResults::nnodes);
+    RLogger::debug("Results elements: %u\n",this->RResults::nelements);
+    RFileIO::writeBinary(modelFile,this->RResults::nelements);
+    RLogger::debug("variables: %u\n",this->RResults::variables.size());
+    RFileIO::writeBinary(modelFile,uint(this->RResults::variables.size()));
+    for (uint i=0;i<this->RResults::variables.size();i++)
+    {
+        RFileIO::writeBinary(modelFile,this->RResults::variables[i]);
+    }
+
+    modelFile.commit();
+} /* RModel::writeBinaryResults */
+
+
+std::vector<RUVector> RModel::findSurfaceNeighbors() const
+{
+    RLogger::info("Finding surface neighbors\n");
+    RLogger::indent();
+    std::vector<RUVector> neigs = this->findElementNeighbors(R_ENTITY_GROUP_SURFACE);
     RLogger::unindent();
     return neigs;
 } /* RModel::findSurfaceNeighbors */
 
 std::vector<RUVector> RModel::findVolumeNeighbors() const
 {
-    std::vector<RUVector> neigs;
-
     RLogger::info("Finding volume neighbors\n");
     RLogger::indent();
-    RProgressInitialize("Finding volume neighbors");
+    std::vector<RUVector> neigs = this->findElementNeighbors(R_ENTITY_GROUP_VOLUME);
+    RLogger::unindent();
+    return neigs;
+} /* RModel::findVolumeNeighbors */
 
-    neigs.resize(this->getNElements());
 
-    RUVector volumeElements;
-    RUVector volumeNeighborCount;
-    volumeElements.reserve(this->getNElements());
-    volumeNeighborCount.resize(this->getNElements());
-    for (uint i=0;i<this->getNElements();i++)
+std::vector<RUVector> RModel::findElementNeighbors(REntityGroupType elementGroupType) const
+{
+    uint nElements = this->getNElements();
+
+    std::vector<RUVector> neigs;
+    neigs.resize(nElements);
+
+    // Every element side is a key.
+    // Elements sharing same key are neighbor candidates.
+    std::vector<uint64_t> keyOffsets(nElements+1,0);
+    for (uint i=0;i<nElements;i++)
     {
-        if (R_ELEMENT_TYPE_IS_VOLUME(this->getElement(i).getType()))
+        const RElement &rElement = this->getElement(i);
+        uint nKeys = 0;
+        if (RElementGroup::getGroupType(rElement.getType()) == elementGroupType)
         {
-            volumeElements.push_back(i);
-            volumeNeighborCount[i] = RElement::getNNeighbors(this->getElement(i).getType());
-            neigs[i].reserve(volumeNeighborCount[i]);
+            nKeys = findNSideKeys(rElement);
         }
+        keyOffsets[i+1] = keyOffsets[i] + nKeys;
     }
 
-    uint64_t nProcessed = 0;
+    std::vector<ElementSideKey> sideKeys(keyOffsets[nElements]);
+
 #pragma omp parallel for default(shared)
-    for (int64_t i=0;i<int64_t(volumeElements.size());i++)
+    for (int64_t i=0;i<int64_t(nElements);i++)
     {
-#pragma omp critical
+        uint64_t keyPosition = keyOffsets[uint(i)];
+        if (keyPosition == keyOffsets[uint(i)+1])
         {
-            RProgressPrint(++nProcessed,uint64_t(volumeElements.size()));
+            continue;
         }
-        uint elementID1 = volumeElements[uint(i)];
 
-        if (neigs[elementID1].size() >= volumeNeighborCount[elementID1])
+        const RElement &rElement = this->getElement(uint(i));
+        uint nKeys = uint(keyOffsets[uint(i)+1] - keyPosition);
+        for (uint j=0;j<nKeys;j++)
         {
-            continue;
+            fillSideKey(rElement,uint(i),j,sideKeys[keyPosition++]);
         }
+    }
 
-        RLimitBox lb1,lb2;
-        this->getElement(elementID1).findLimitBox(this->getNodes(),lb1);
+    std::sort(sideKeys.begin(),sideKeys.end());
 
-        for (uint j=uint(i+1);j<volumeElements.size();j++)
+    // Collect candidate pairs from elements sharing the same key.
+    std::vector< std::pair<uint,uint> > candidates;
+    for (uint64_t i=0;i<sideKeys.size();)
+    {
+        uint64_t j = i + 1;
+        while (j < sideKeys.size() && sideKeys[i].hasSameSide(sideKeys[j]))
         {
-            uint elementID2 = volumeElements[j];
-
-            if (neigs[elementID2].size() >= volumeNeighborCount[elementID2])
-            {
-                continue;
-            }
-
-            this->getElement(elementID2).findLimitBox(this->getNodes(),lb2);
-            if (!RLimitBox::areIntersecting(lb1,lb2))
-            {
-                continue;
-            }
-
-            bool skip = false;
-            if (this->getElement(elementID1).isNeighbor(this->getElement(elementID2)))
+            j++;
+        }
+        for (uint64_t k=i;k<j;k++)
+        {
+            for (uint64_t l=k+1;l<j;l++)
             {
-#pragma omp critical
-                {
-                    neigs[elementID1].push_back(elementID2);
-                    neigs[elementID2].push_back(elementID1);
-                }
-                if (neigs[elementID1].size() == volumeNeighborCount[elementID1])
+                if (sideKeys[k].elementID != sideKeys[l].elementID)
                 {
-                    skip = true;
+                    candidates.push_back(std::pair<uint,uint>(sideKeys[k].elementID,sideKeys[l].elementID));
                 }
             }
-            if (skip)
-            {
-                break;
-            }
         }
+        i = j;
     }
+    sideKeys.clear();
 
-    RProgressFinalize();
-    RLogger::unindent();
+    std::sort(candidates.begin(),candidates.end());
+    candidates.erase(std::unique(candidates.begin(),candidates.end()),candidates.end());
+
+    // Verify candidates.
+    std::vector<char> isNeighbor(candidates.size(),false);
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(candidates.size());i++)
+    {
+        const RElement &rElement1 = this->getElement(candidates[uint64_t(i)].first);
+        const RElement &rElement2 = this->getElement(candidates[uint64_t(i)].second);
+        isNeighbor[uint64_t(i)] = rElement1.isNeighbor(rElement2);
+    }
+
+    for (uint i=0;i<nElements;i++)
+    {
+        if (keyOffsets[i] != keyOffsets[i+1])
+        {
+            neigs[i].reserve(RElement::getNNeighbors(this->getElement(i).getType()));
+        }
+    }
+
+    for (uint64_t i=0;i<candidates.size();i++)
+    {
+        if (isNeighbor[i])
+        {
+            neigs[candidates[i].first].push_back(candidates[i].second);
+            neigs[candidates[i].second].push_back(candidates[i].first);
+        }
+    }
 
     return neigs;
-} /* RModel::findVolumeNeighbors */
+} /* RModel::findElementNeighbors */
+
+
+std::vector<uint> RModel::findDuplicateElements(const std::vector<uint> &elementIDs) const
+{
+    uint ne = uint(elementIDs.size());
+
+    std::vector<RElementKey> keys(ne);
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(ne);i++)
+    {
+        this->getElement(elementIDs[uint(i)]).findKey(keys[uint(i)]);
+    }
+
+    // Sort positions by keys, equal keys are kept in original order.
+    std::vector<uint> order(ne);
+    for (uint i=0;i<ne;i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(),order.end(),[&keys](uint a, uint b)
+    {
+        int result = RElement::compareKeys(keys[a],keys[b]);
+        return (result < 0 || (result == 0 && a < b));
+    });
+
+    // Sweep runs of equal keys, all but first element in each run are duplicates.
+    std::vector<uint> duplicateIDs;
+    for (uint i=1;i<ne;i++)
+    {
+        if (RElement::compareKeys(keys[order[i-1]],keys[order[i]]) == 0)
+        {
+            duplicateIDs.push_back(elementIDs[order[i]]);
+        }
+    }
+    std::sort(duplicateIDs.begin(),duplicateIDs.end());
+
+    return duplicateIDs;
+} /* RModel::findDuplicateElements */
 
 
 void RModel::markSurfaceNeighbors(uint elementID,
@@ -8286,41 +9379,6 @@ void RModel::generateElementDistanceVector(uint startElementID, uint maximumDist
 
 uint RModel::findNearNode(const RNode &node, double tolerance, bool findNearest, uint nodeID) const
 {
-    uint nn = this->getNNodes();
-    uint nearNode = RConstants::eod;
-    double minDistance = DBL_MAX;
-
-    for (uint i=0;i<nn;i++)
-    {
-        if (i == nodeID)
-        {
-            continue;
-        }
-        if (tolerance == 0.0)
-        {
-            if (this->getNode(i) == node)
-            {
-                nearNode = i;
-                break;
-            }
-        }
-        else
-        {
-            double distance = this->getNode(i).getDistance(node);
-            if (distance < tolerance)
-            {
-                if (distance < minDistance)
-                {
-                    minDistance = distance;
-                    nearNode = i;
-                    if (!findNearest)
-                    {
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    return nearNode;
+    // Distance must be strictly smaller than tolerance, zero tolerance requires identical node.
+    return this->getNodeGrid(tolerance)->findNearNode(this->nodes,node,findNearest,true,nodeID);
 } /* RModel::findNearNode */
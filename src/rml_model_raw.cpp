@@ -29,6 +29,8 @@ RModelRaw::~RModelRaw ()
 
 void RModelRaw::_init(const RModelRaw *pModelRaw)
 {
+    this->nodeGrid = RNodeGrid();
+    this->nGridNodes = 0;
     if (pModelRaw)
     {
         this->nodes = pModelRaw->nodes;
@@ -60,6 +62,9 @@ const RNode & RModelRaw::getNode(unsigned int position) const
 RNode & RModelRaw::getNode(unsigned int position)
 {
     R_ERROR_ASSERT(position < this->nodes.size());
+    // Node may be modified, therefore node search grid must be rebuilt.
+    this->nGridNodes = 0;
+    this->nodeGrid.clear();
     return this->nodes[position];
 } /* RModelRaw::getNode */
 
@@ -270,121 +275,63 @@ void RModelRaw::addQuadrilateral(const RNode &node1, const RNode &node2, const R
 unsigned int RModelRaw::findNearNode (const RNode &node,
                                       double       tolerance) const
 {
-    unsigned int nn = this->getNNodes();
+    if (this->nodeGrid.getTolerance() != tolerance || this->nGridNodes > this->nodes.size())
+    {
+        this->nodeGrid = RNodeGrid(tolerance);
+        this->nGridNodes = 0;
+    }
 
-    for (unsigned int i=0;i<nn;i++)
+    // Register nodes added since last search.
+    for (unsigned int i=this->nGridNodes;i<this->nodes.size();i++)
     {
-        if (tolerance == 0.0)
-        {
-            if (this->getNode(i) == node)
-            {
-                return i;
-            }
-        }
-        else
-        {
-            if (this->getNode(i).getDistance(node) <= tolerance)
-            {
-                return i;
-            }
-        }
+        this->nodeGrid.insert(this->nodes[i],i);
     }
+    this->nGridNodes = (unsigned int)this->nodes.size();
 
-    return RConstants::eod;
+    return this->nodeGrid.findNearNode(this->nodes,node);
 } /* RModelRaw::findNearNode */
 
 
 unsigned int RModelRaw::mergeNearNodes (double tolerance)
 {
-    unsigned int nMerged = 0;
-    std::vector<unsigned int> nodeBook;
-    nodeBook.resize(this->getNNodes());
-
     RLogger::info("Finding near nodes\n");
-    RProgressInitialize("Finfing near nodes");
-    unsigned int nn = this->getNNodes();
-    for (unsigned int i=0;i<nn;i++)
-    {
-        nodeBook[i] = i;
-    }
-    for (unsigned int i=0;i<nn;i++)
+    std::vector<unsigned int> mergeMap;
+    unsigned int nMerged = RNodeGrid::findMergeMap(this->nodes,tolerance,mergeMap);
+
+    if (nMerged == 0)
     {
-        RProgressPrint(i,nn);
-        if (nodeBook[i] != i)
-        {
-            continue;
-        }
-#pragma omp parallel for default(shared)
-        for (int64_t j=int64_t(i)+1;j<int64_t(nn);j++)
-        {
-            if (nodeBook[j] != j)
-            {
-                continue;
-            }
-            if (tolerance == 0.0)
-            {
-                if (this->getNode(i) != this->getNode(j))
-                {
-                    continue;
-                }
-            }
-            else
-            {
-                if (this->getNode(i).getDistance(this->getNode(j)) > tolerance)
-                {
-                    continue;
-                }
-            }
-            nodeBook[j] = i;
-        }
+        return 0;
     }
-    RProgressFinalize("Done");
+
+    std::vector<unsigned int> nodeBook;
+    std::vector<unsigned int> removeBook;
+    RNodeGrid::findNodeBook(mergeMap,nodeBook,removeBook);
 
     RLogger::info("Merging near nodes\n");
-    RProgressInitialize("Merging near nodes");
-    for (unsigned int i=0;i<nn;i++)
+    unsigned int nn = 0;
+    for (unsigned int i=0;i<this->nodes.size();i++)
     {
-        RProgressPrint(i,nn);
-        unsigned int nID = nn-i-1;
-        if (nodeBook[nID] != nID)
+        if (removeBook[i] != RConstants::eod)
         {
-            // Remove node from node vector.
-            std::vector<RNode>::iterator iter = this->nodes.begin();
-            std::advance(iter, nID);
-            this->nodes.erase(iter);
-            nMerged ++;
+            this->nodes[nn++] = this->nodes[i];
         }
     }
-    RProgressFinalize("Done");
+    this->nodes.resize(nn);
 
-    RLogger::info("Renumbering merged nodes nodes\n");
-    nn = 0;
-    for (unsigned int i=0;i<nodeBook.size();i++)
+    RLogger::info("Renumbering merged nodes\n");
+    // Renumber node IDs in element vector.
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->elements.size());i++)
     {
-
-        if (nodeBook[i] == i)
-        {
-            nodeBook[i] = nn;
-            nn++;
-        }
-        else
+        RElement &rElement = this->elements[uint(i)];
+        for (unsigned int j=0;j<rElement.size();j++)
         {
-            nodeBook[i] = nodeBook[nodeBook[i]];
+            rElement.setNodeId(j,nodeBook[rElement.getNodeId(j)]);
         }
     }
 
-    RProgressInitialize("Renumbering merged nodes nodes");
-    // Renumber all higher node IDs in element vector.
-    unsigned int ne = this->getNElements();
-    for (unsigned int i=0;i<ne;i++)
-    {
-        RProgressPrint(i,ne);
-        for (unsigned int j=0;j<this->getElement(i).size();j++)
-        {
-            this->getElement(i).setNodeId(j,nodeBook[this->getElement(i).getNodeId(j)]);
-        }
-    }
-    RProgressFinalize("Done");
+    this->nGridNodes = 0;
+    this->nodeGrid.clear();
 
     return nMerged;
 } /* RModelRaw::mergeNearNodes */
@@ -394,6 +341,8 @@ void RModelRaw::clear (void)
 {
     this->nodes.clear();
     this->elements.clear();
+    this->nGridNodes = 0;
+    this->nodeGrid.clear();
 } /* RModelRaw::clear */
 
 
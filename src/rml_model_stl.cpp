@@ -2,6 +2,10 @@
 #include <QFileInfo>
 #include <QTextStream>
 #include <QRegularExpression>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
 
 #include <rbl_error.h>
 #include <rbl_logger.h>
@@ -9,6 +13,7 @@
 
 #include "rml_model_stl.h"
 #include "rml_model_raw.h"
+#include "rml_ascii_parser.h"
 
 
 RModelStl::RModelStl ()
@@ -107,15 +112,26 @@ void RModelStl::write (const QString &fileName, bool binary) const
 } /* RModelStl::write */
 
 
+unsigned int RModelStl::weldNode(RNodeGrid &weldGrid, std::vector<RNode> &nodes, const RNode &node)
+{
+    // Vertices are welded while reading, so that only unique nodes are ever stored.
+    unsigned int nId = weldGrid.findNearNode(nodes,node);
+    if (nId == RConstants::eod)
+    {
+        nId = (unsigned int)nodes.size();
+        nodes.push_back(node);
+        weldGrid.insert(node,nId);
+    }
+    return nId;
+} /* RModelStl::weldNode */
+
+
 void RModelStl::readBinary(const QString &fileName, double tolerance)
 {
-    RNode node1;
-    RNode node2;
-    RNode node3;
-    float xyz[3];
-    double x1, y1, z1;
-    double x2, y2, z2;
-    double x3, y3, z3;
+    // Facet record: normal (3 x float), 3 vertices (3 x 3 x float) and attribute byte count (uint16).
+    const qint64 facetSize = 12*qint64(sizeof(float)) + 2;
+    // Number of facets read at once.
+    const qint64 nBufferFacets = 16384;
 
     RProgressInitialize("Reading STL binary file");
 
@@ -150,69 +166,62 @@ void RModelStl::readBinary(const QString &fileName, double tolerance)
         }
     }
 
-    unsigned int nf;
-    stlFile.read((char*)&nf,sizeof(unsigned int));
-    if (stlFile.error() != QFile::NoError)
+    uchar nfBuffer[sizeof(quint32)];
+    if (stlFile.read((char*)nfBuffer,sizeof(quint32)) != qint64(sizeof(quint32)))
     {
         throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
     }
+    unsigned int nf = qFromLittleEndian<quint32>(nfBuffer);
+
+    if (stlFile.size() - stlFile.pos() < qint64(nf)*facetSize)
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"File \'%s\' is too short to contain %u facets.",fileName.toUtf8().constData(),nf);
+    }
 
-    char dummy[2];
+    RNodeGrid weldGrid(tolerance);
+    weldGrid.insert(this->nodes);
+    this->elements.reserve(this->elements.size() + nf);
 
-    for (unsigned int i=0;i<nf;i++)
+    std::vector<uchar> buffer(size_t(std::min(qint64(nf),nBufferFacets)*facetSize));
+
+    unsigned int i = 0;
+    while (i < nf)
     {
         RProgressPrint(i+1,nf);
 
-        stlFile.read((char*)xyz,3*sizeof(float));
-        if (stlFile.error() != QFile::NoError)
+        unsigned int nChunkFacets = (unsigned int)std::min(qint64(nf - i),nBufferFacets);
+        qint64 nChunkBytes = qint64(nChunkFacets)*facetSize;
+        if (stlFile.read((char*)buffer.data(),nChunkBytes) != nChunkBytes)
         {
             throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
         }
 
-        stlFile.read((char*)xyz,3*sizeof(float));
-        if (stlFile.error() != QFile::NoError)
+        for (unsigned int j=0;j<nChunkFacets;j++)
         {
-            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
-        }
-        x1 = (double) xyz[0];
-        y1 = (double) xyz[1];
-        z1 = (double) xyz[2];
+            // Skip normal vector.
+            const uchar *facet = buffer.data() + qint64(j)*facetSize + 3*sizeof(float);
 
-        stlFile.read((char*)xyz,3*sizeof(float));
-        if (stlFile.error() != QFile::NoError)
-        {
-            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
-        }
-        x2 = (double) xyz[0];
-        y2 = (double) xyz[1];
-        z2 = (double) xyz[2];
+            RElement element(R_ELEMENT_TRI1);
+            for (unsigned int k=0;k<3;k++)
+            {
+                RNode node(double(qFromLittleEndian<float>(facet)),
+                           double(qFromLittleEndian<float>(facet + sizeof(float))),
+                           double(qFromLittleEndian<float>(facet + 2*sizeof(float))));
+                facet += 3*sizeof(float);
 
-        stlFile.read((char*)xyz,3*sizeof(float));
-        if (stlFile.error() != QFile::NoError)
-        {
-            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
+                element.setNodeId(k,RModelStl::weldNode(weldGrid,this->nodes,node));
+            }
+            this->elements.push_back(element);
         }
-        x3 = (double) xyz[0];
-        y3 = (double) xyz[1];
-        z3 = (double) xyz[2];
 
-        node1.set(x1,y1,z1);
-        node2.set(x2,y2,z2);
-        node3.set(x3,y3,z3);
-        this->addTriangle(node1,node2,node3,false,tolerance);
-
-        stlFile.read(dummy,2);
-        if (stlFile.error() != QFile::NoError)
-        {
-            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
-        }
+        i += nChunkFacets;
     }
 
     stlFile.close ();
 
     RProgressFinalize("Done");
 
-    this->mergeNearNodes(tolerance);
+    RLogger::info("Read %u facets with %u unique nodes\n",nf,this->getNNodes());
 } /* RModelStl::readBinary */
 
 
@@ -293,18 +302,16 @@ void RModelStl::writeBinary (const QString &fileName) const
 } /* RModelStl::writeBinary */
 
 
+bool RModelStl::isKeyword (const char *tokenBegin, const char *tokenEnd, const char *keyword)
+{
+    size_t length = std::strlen(keyword);
+    return (size_t(tokenEnd - tokenBegin) == length && qstrnicmp(tokenBegin,keyword,length) == 0);
+} /* RModelStl::isKeyword */
+
+
 void RModelStl::readAscii (const QString &fileName,
                            double             tolerance)
 {
-    RNode node1;
-    RNode node2;
-    RNode node3;
-    double nx, ny, nz;
-    double x1, y1, z1;
-    double x2, y2, z2;
-    double x3, y3, z3;
-    QString flag;
-
     RProgressInitialize("Reading STL ASCII file");
 
     if (fileName.isEmpty())
@@ -314,19 +321,39 @@ void RModelStl::readAscii (const QString &fileName,
 
     QFile file(fileName);
 
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!file.open(QIODevice::ReadOnly))
     {
         throw RError(RError::Type::OpenFile,R_ERROR_REF,"Failed to open the file \'%s\'.",fileName.toUtf8().constData());
     }
 
-    QTextStream in(&file);
+    // File is parsed directly from memory, mapping falls back to reading whole file.
+    qint64 size = file.size();
+    QByteArray content;
+    const char *data = (size > 0) ? (const char*)file.map(0,size) : nullptr;
+    bool mapped = (data != nullptr);
+    if (!mapped)
+    {
+        content = file.readAll();
+        if (file.error() != QFile::NoError)
+        {
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read from file \'%s\'.",fileName.toUtf8().constData());
+        }
+        data = content.constData();
+        size = content.size();
+    }
+    const char *end = data + size;
 
-    QString line;
-    line = in.readLine();
-    if (in.status() != QTextStream::Ok)
+    const char *lineEnd = (const char*)std::memchr(data,'\n',size_t(size));
+    if (!lineEnd)
     {
-        throw RError(RError::Type::ReadFile,R_ERROR_REF, "Failed to read first line (1).");
+        lineEnd = end;
     }
+    qsizetype lineLength = qsizetype(lineEnd - data);
+    if (lineLength > 0 && data[lineLength-1] == '\r')
+    {
+        lineLength--;
+    }
+    QString line(QString::fromUtf8(data,lineLength));
 
     this->name = QFileInfo(fileName).baseName();
 
@@ -342,87 +369,85 @@ void RModelStl::readAscii (const QString &fileName,
         }
     }
 
+    RNodeGrid weldGrid(tolerance);
+    weldGrid.insert(this->nodes);
+
+    const char *cursor = lineEnd;
+    const char *tokenBegin = nullptr;
+    const char *tokenEnd = nullptr;
     unsigned int nf = 0;
-    while (!in.atEnd() && in.status() == QTextStream::Ok)
+    while (RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd))
     {
-        in >> flag;
-        if (flag == "normal" || flag == "NORMAL")
+        if (RModelStl::isKeyword(tokenBegin,tokenEnd,"endsolid") || RModelStl::isKeyword(tokenBegin,tokenEnd,"solid"))
         {
-            nf++;
+            // Skip rest of the line containing solid name.
+            const char *nextLine = (const char*)std::memchr(cursor,'\n',size_t(end - cursor));
+            cursor = nextLine ? nextLine : end;
+            continue;
         }
-    }
-    in.resetStatus();
 
-    in.seek(0);
-    if (in.status() != QTextStream::Ok)
-    {
-        throw RError(RError::Type::ReadFile,R_ERROR_REF, "Failed to set position.");
-    }
+        RProgressPrint(double(tokenBegin - data)/double(size));
 
-    line = in.readLine();
-    if (in.status() != QTextStream::Ok)
-    {
-        throw RError(RError::Type::ReadFile,R_ERROR_REF, "Failed to read first line (2).");
-    }
-
-    for (unsigned int i=0;i<nf;i++)
-    {
-        RProgressPrint(i+1,nf);
+        nf++;
 
-        in >> flag >> flag >> nx >> ny >> nz;
-        if (in.status() != QTextStream::Ok)
-        {
-            QString errorStr("Failed to read normal (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
-        }
-        in >> flag >> flag;
-        if (in.status() != QTextStream::Ok)
-        {
-            QString errorStr("Failed to read outer loop (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
-        }
-        in >> flag >> x1 >> y1 >> z1;
-        if (in.status() != QTextStream::Ok)
+        double nx, ny, nz;
+        if (!RModelStl::isKeyword(tokenBegin,tokenEnd,"facet")
+            || !RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+            || !RModelStl::isKeyword(tokenBegin,tokenEnd,"normal")
+            || !RAsciiParser::parseDouble(cursor,end,nx)
+            || !RAsciiParser::parseDouble(cursor,end,ny)
+            || !RAsciiParser::parseDouble(cursor,end,nz))
         {
-            QString errorStr("Failed to read vertex 1 (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read normal (Facet: %u).",nf);
         }
-        in >> flag >> x2 >> y2 >> z2;
-        if (in.status() != QTextStream::Ok)
+        if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+            || !RModelStl::isKeyword(tokenBegin,tokenEnd,"outer")
+            || !RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+            || !RModelStl::isKeyword(tokenBegin,tokenEnd,"loop"))
         {
-            QString errorStr("Failed to read vertex 2 (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read outer loop (Facet: %u).",nf);
         }
-        in >> flag >> x3 >> y3 >> z3;
-        if (in.status() != QTextStream::Ok)
+
+        RElement element(R_ELEMENT_TRI1);
+        for (unsigned int k=0;k<3;k++)
         {
-            QString errorStr("Failed to read vertex 3 (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
+            double x, y, z;
+            if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+                || !RModelStl::isKeyword(tokenBegin,tokenEnd,"vertex")
+                || !RAsciiParser::parseDouble(cursor,end,x)
+                || !RAsciiParser::parseDouble(cursor,end,y)
+                || !RAsciiParser::parseDouble(cursor,end,z))
+            {
+                throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read vertex %u (Facet: %u).",k+1,nf);
+            }
+
+            RNode node(x,y,z);
+            element.setNodeId(k,RModelStl::weldNode(weldGrid,this->nodes,node));
         }
-        in >> flag;
-        if (in.status() != QTextStream::Ok)
+
+        if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+            || !RModelStl::isKeyword(tokenBegin,tokenEnd,"endloop"))
         {
-            QString errorStr("Failed to read endloop (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read endloop (Facet: %u).",nf);
         }
-        in >> flag;
-        if (in.status() != QTextStream::Ok)
+        if (!RAsciiParser::findToken(cursor,end,tokenBegin,tokenEnd)
+            || !RModelStl::isKeyword(tokenBegin,tokenEnd,"endfacet"))
         {
-            QString errorStr("Failed to read endfacet (Facet: " + QString::number(i+1) + " of " + QString::number(nf) + ").");
-            throw RError(RError::Type::ReadFile,R_ERROR_REF, errorStr);
+            throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to read endfacet (Facet: %u).",nf);
         }
 
-        node1.set(x1,y1,z1);
-        node2.set(x2,y2,z2);
-        node3.set(x3,y3,z3);
-        this->addTriangle(node1,node2,node3,false,tolerance);
+        this->elements.push_back(element);
     }
 
+    if (mapped)
+    {
+        file.unmap((uchar*)data);
+    }
     file.close ();
 
     RProgressFinalize("Done");
 
-    this->mergeNearNodes(tolerance);
+    RLogger::info("Read %u facets with %u unique nodes\n",nf,this->getNNodes());
 } /* RModelStl::readAscii */
 
 
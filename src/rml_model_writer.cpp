@@ -0,0 +1,115 @@
+#include <algorithm>
+
+#include <rbl_error.h>
+#include <rbl_logger.h>
+
+#include "rml_model_writer.h"
+
+const uint RModelWriter::defaultQueueSize = 2;
+
+RModelWriter::RModelWriter(uint queueSize)
+    : queueSize(std::max(queueSize,1U))
+    , nActive(0)
+    , stopRequested(false)
+{
+    this->thread = std::thread(&RModelWriter::run,this);
+}
+
+RModelWriter::~RModelWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopRequested = true;
+    }
+    this->condition.notify_all();
+    if (this->thread.joinable())
+    {
+        this->thread.join();
+    }
+}
+
+void RModelWriter::run(void)
+{
+    while (true)
+    {
+        std::shared_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock,[this]{ return this->stopRequested || !this->queue.empty(); });
+            if (this->queue.empty())
+            {
+                // Stop was requested and everything was written.
+                return;
+            }
+            request = this->queue.front();
+            this->queue.pop_front();
+            this->nActive++;
+        }
+        this->condition.notify_all();
+
+        try
+        {
+            request->promise.set_value(request->model.write(request->fileName,request->writeLinkFile,request->baseFileName));
+        }
+        catch (const RError &error)
+        {
+            RLogger::warning("Failed to write model file \'%s\'. %s\n",request->fileName.toUtf8().constData(),error.getMessage().toUtf8().constData());
+            request->promise.set_exception(std::current_exception());
+        }
+        catch (...)
+        {
+            request->promise.set_exception(std::current_exception());
+        }
+        // Release snapshot before signaling completion.
+        request.reset();
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->nActive--;
+        }
+        this->condition.notify_all();
+    }
+}
+
+std::shared_future<QString> RModelWriter::write(const RModel &model, const QString &fileName, bool writeLinkFile, const QString &baseFileName)
+{
+    if (fileName.isEmpty())
+    {
+        throw RError(RError::Type::InvalidFileName,R_ERROR_REF,"No file name was provided.");
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condition.wait(lock,[this]{ return this->stopRequested || this->queue.size() < this->queueSize; });
+    }
+
+    // Snapshot is taken outside of lock so that I/O thread is not blocked.
+    std::shared_ptr<Request> request(new Request{model.createWriteSnapshot(fileName,baseFileName),fileName,writeLinkFile,baseFileName,std::promise<QString>()});
+    std::shared_future<QString> future(request->promise.get_future().share());
+
+    {
+        // Other caller may have filled the queue while snapshot was taken.
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condition.wait(lock,[this]{ return this->stopRequested || this->queue.size() < this->queueSize; });
+        if (this->stopRequested)
+        {
+            throw RError(RError::Type::Application,R_ERROR_REF,"Model writer is stopped.");
+        }
+        this->queue.push_back(request);
+    }
+    this->condition.notify_all();
+
+    return future;
+}
+
+void RModelWriter::flush(void)
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->condition.wait(lock,[this]{ return this->queue.empty() && this->nActive == 0; });
+}
+
+uint RModelWriter::getNPending(void) const
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return uint(this->queue.size()) + this->nActive;
+}
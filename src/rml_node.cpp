@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cmath>
+#include <omp.h>
 
 #include "rml_node.h"
 
@@ -31,17 +33,6 @@ RNode::RNode (const RR3Vector &vector)
 } /* RNode::RNode */
 
 
-RNode::RNode (const RNode &node)
-{
-    this->_init (&node);
-} /* RNode::RNode - copy */
-
-
-RNode::~RNode ()
-{
-} /* RNode::~RNode */
-
-
 void RNode::_init (const RNode *pNode)
 {
     if (pNode)
@@ -109,13 +100,6 @@ void RNode::scale(const RR3Vector &scaleVector)
 } /* RNode::scale */
 
 
-RNode & RNode::operator = (const RNode &node)
-{
-    this->_init (&node);
-    return (*this);
-} /* RNode::operator = */
-
-
 bool RNode::operator == (const RNode &node) const
 {
     if (this->getX() == node.getX() &&
@@ -177,3 +161,130 @@ void RNode::print(void) const
 {
     this->toVector().print(true,true);
 } /*RNode::print */
+
+
+void RNode::findNodeLimits(const std::vector<RNode> &nodes, double &xmin, double &xmax, double &ymin, double &ymax, double &zmin, double &zmax)
+{
+    xmin = xmax = ymin = ymax = zmin = zmax = 0.0;
+
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    // Each chunk finds its own limits which are combined afterwards.
+    int64_t nChunks = std::min(int64_t(omp_get_max_threads()),int64_t(nodes.size()));
+    std::vector<double> limits(6*size_t(nChunks));
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<nChunks;i++)
+    {
+        size_t first = size_t(i) * nodes.size() / size_t(nChunks);
+        size_t last = size_t(i+1) * nodes.size() / size_t(nChunks);
+
+        double cxmin = nodes[first].x, cxmax = nodes[first].x;
+        double cymin = nodes[first].y, cymax = nodes[first].y;
+        double czmin = nodes[first].z, czmax = nodes[first].z;
+        for (size_t j=first+1;j<last;j++)
+        {
+            cxmin = std::min(cxmin,nodes[j].x);
+            cxmax = std::max(cxmax,nodes[j].x);
+            cymin = std::min(cymin,nodes[j].y);
+            cymax = std::max(cymax,nodes[j].y);
+            czmin = std::min(czmin,nodes[j].z);
+            czmax = std::max(czmax,nodes[j].z);
+        }
+
+        double *chunkLimits = &limits[6*size_t(i)];
+        chunkLimits[0] = cxmin;
+        chunkLimits[1] = cxmax;
+        chunkLimits[2] = cymin;
+        chunkLimits[3] = cymax;
+        chunkLimits[4] = czmin;
+        chunkLimits[5] = czmax;
+    }
+
+    xmin = limits[0];
+    xmax = limits[1];
+    ymin = limits[2];
+    ymax = limits[3];
+    zmin = limits[4];
+    zmax = limits[5];
+    for (int64_t i=1;i<nChunks;i++)
+    {
+        const double *chunkLimits = &limits[6*size_t(i)];
+        xmin = std::min(xmin,chunkLimits[0]);
+        xmax = std::max(xmax,chunkLimits[1]);
+        ymin = std::min(ymin,chunkLimits[2]);
+        ymax = std::max(ymax,chunkLimits[3]);
+        zmin = std::min(zmin,chunkLimits[4]);
+        zmax = std::max(zmax,chunkLimits[5]);
+    }
+} /* RNode::findNodeLimits */
+
+
+void RNode::transformNodes(std::vector<RNode> &nodes, const std::vector<uint> &nodeIDs, const RRMatrix &R, const RR3Vector &t1, const RR3Vector &t2)
+{
+    // Copy matrix to local variables so that the loop body is plain arithmetic.
+    const double r00 = R[0][0], r01 = R[0][1], r02 = R[0][2];
+    const double r10 = R[1][0], r11 = R[1][1], r12 = R[1][2];
+    const double r20 = R[2][0], r21 = R[2][1], r22 = R[2][2];
+    const double t1x = t1[0], t1y = t1[1], t1z = t1[2];
+    const double t2x = t2[0], t2y = t2[1], t2z = t2[2];
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodeIDs.size());i++)
+    {
+        RNode &rNode = nodes[nodeIDs[size_t(i)]];
+        double x = rNode.x + t1x;
+        double y = rNode.y + t1y;
+        double z = rNode.z + t1z;
+        rNode.x = r00 * x + r01 * y + r02 * z + t2x;
+        rNode.y = r10 * x + r11 * y + r12 * z + t2y;
+        rNode.z = r20 * x + r21 * y + r22 * z + t2z;
+    }
+} /* RNode::transformNodes */
+
+
+void RNode::translateNodes(std::vector<RNode> &nodes, const std::vector<uint> &nodeIDs, const RR3Vector &t)
+{
+    const double tx = t[0], ty = t[1], tz = t[2];
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodeIDs.size());i++)
+    {
+        RNode &rNode = nodes[nodeIDs[size_t(i)]];
+        rNode.x += tx;
+        rNode.y += ty;
+        rNode.z += tz;
+    }
+} /* RNode::translateNodes */
+
+
+void RNode::scaleNodes(std::vector<RNode> &nodes, const std::vector<uint> &nodeIDs, const RR3Vector &scaleVector, const RR3Vector &center)
+{
+    const double sx = scaleVector[0], sy = scaleVector[1], sz = scaleVector[2];
+    const double cx = center[0], cy = center[1], cz = center[2];
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodeIDs.size());i++)
+    {
+        RNode &rNode = nodes[nodeIDs[size_t(i)]];
+        rNode.x = (rNode.x - cx) * sx + cx;
+        rNode.y = (rNode.y - cy) * sy + cy;
+        rNode.z = (rNode.z - cz) * sz + cz;
+    }
+} /* RNode::scaleNodes */
+
+
+void RNode::scaleNodes(std::vector<RNode> &nodes, double scale)
+{
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(nodes.size());i++)
+    {
+        RNode &rNode = nodes[size_t(i)];
+        rNode.x *= scale;
+        rNode.y *= scale;
+        rNode.z *= scale;
+    }
+} /* RNode::scaleNodes */
@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rbl_progress.h>
+
+#include "rml_node_grid.h"
+
+static const int64_t maxCellIndex = int64_t(1) << 60;
+
+const double RNodeGrid::minCellSize = 1.0e-9;
+
+void RNodeGrid::_init(const RNodeGrid *pNodeGrid)
+{
+    if (pNodeGrid)
+    {
+        this->tolerance = pNodeGrid->tolerance;
+        this->cellSize = pNodeGrid->cellSize;
+        this->cells = pNodeGrid->cells;
+    }
+}
+
+RNodeGrid::RNodeGrid(double tolerance, double cellSize)
+    : tolerance(std::max(tolerance,0.0))
+    , cellSize(std::max(std::max(cellSize,tolerance),RNodeGrid::minCellSize))
+{
+    this->_init();
+}
+
+RNodeGrid::RNodeGrid(const RNodeGrid &nodeGrid)
+{
+    this->_init(&nodeGrid);
+}
+
+RNodeGrid::~RNodeGrid()
+{
+
+}
+
+RNodeGrid &RNodeGrid::operator =(const RNodeGrid &nodeGrid)
+{
+    this->_init(&nodeGrid);
+    return (*this);
+}
+
+double RNodeGrid::getTolerance(void) const
+{
+    return this->tolerance;
+}
+
+void RNodeGrid::reserve(uint nNodes)
+{
+    this->cells.reserve(nNodes);
+}
+
+void RNodeGrid::clear(void)
+{
+    this->cells.clear();
+}
+
+void RNodeGrid::insert(const RNode &node, uint nodeID)
+{
+    uint64_t key = RNodeGrid::findCellKey(this->findCellIndex(node.getX()),
+                                          this->findCellIndex(node.getY()),
+                                          this->findCellIndex(node.getZ()));
+    this->cells[key].push_back(nodeID);
+}
+
+void RNodeGrid::insert(const std::vector<RNode> &nodes)
+{
+    this->reserve(uint(this->cells.size() + nodes.size()));
+    for (uint i=0;i<nodes.size();i++)
+    {
+        this->insert(nodes[i],i);
+    }
+}
+
+uint RNodeGrid::findNearNode(const std::vector<RNode> &nodes, const RNode &node, bool findNearest, bool strict, uint excludeID) const
+{
+    uint nearNode = RConstants::eod;
+    double minDistance = 0.0;
+
+    int64_t ix1 = this->findCellIndex(node.getX() - this->tolerance);
+    int64_t ix2 = this->findCellIndex(node.getX() + this->tolerance);
+    int64_t iy1 = this->findCellIndex(node.getY() - this->tolerance);
+    int64_t iy2 = this->findCellIndex(node.getY() + this->tolerance);
+    int64_t iz1 = this->findCellIndex(node.getZ() - this->tolerance);
+    int64_t iz2 = this->findCellIndex(node.getZ() + this->tolerance);
+
+    for (int64_t ix=ix1;ix<=ix2;ix++)
+    {
+        for (int64_t iy=iy1;iy<=iy2;iy++)
+        {
+            for (int64_t iz=iz1;iz<=iz2;iz++)
+            {
+                std::unordered_map< uint64_t,std::vector<uint> >::const_iterator iter = this->cells.find(RNodeGrid::findCellKey(ix,iy,iz));
+                if (iter == this->cells.end())
+                {
+                    continue;
+                }
+                const std::vector<uint> &cellNodeIDs = iter->second;
+                for (uint i=0;i<cellNodeIDs.size();i++)
+                {
+                    uint nodeID = cellNodeIDs[i];
+                    if (nodeID == excludeID)
+                    {
+                        continue;
+                    }
+                    double distance = 0.0;
+                    if (this->tolerance == 0.0)
+                    {
+                        if (nodes[nodeID] != node)
+                        {
+                            continue;
+                        }
+                    }
+                    else
+                    {
+                        distance = nodes[nodeID].getDistance(node);
+                        if (strict ? (distance >= this->tolerance) : (distance > this->tolerance))
+                        {
+                            continue;
+                        }
+                    }
+                    if (nearNode == RConstants::eod
+                        ||
+                        (findNearest && (distance < minDistance || (distance == minDistance && nodeID < nearNode)))
+                        ||
+                        (!findNearest && nodeID < nearNode))
+                    {
+                        nearNode = nodeID;
+                        minDistance = distance;
+                    }
+                }
+            }
+        }
+    }
+
+    return nearNode;
+}
+
+std::vector<uint> RNodeGrid::findNearNodes(const std::vector<RNode> &nodes, const RNode &node) const
+{
+    std::vector<uint> nearNodes;
+
+    int64_t ix1 = this->findCellIndex(node.getX() - this->tolerance);
+    int64_t ix2 = this->findCellIndex(node.getX() + this->tolerance);
+    int64_t iy1 = this->findCellIndex(node.getY() - this->tolerance);
+    int64_t iy2 = this->findCellIndex(node.getY() + this->tolerance);
+    int64_t iz1 = this->findCellIndex(node.getZ() - this->tolerance);
+    int64_t iz2 = this->findCellIndex(node.getZ() + this->tolerance);
+
+    for (int64_t ix=ix1;ix<=ix2;ix++)
+    {
+        for (int64_t iy=iy1;iy<=iy2;iy++)
+        {
+            for (int64_t iz=iz1;iz<=iz2;iz++)
+            {
+                std::unordered_map< uint64_t,std::vector<uint> >::const_iterator iter = this->cells.find(RNodeGrid::findCellKey(ix,iy,iz));
+                if (iter == this->cells.end())
+                {
+                    continue;
+                }
+                const std::vector<uint> &cellNodeIDs = iter->second;
+                for (uint i=0;i<cellNodeIDs.size();i++)
+                {
+                    if (nodes[cellNodeIDs[i]].getDistance(node) < this->tolerance)
+                    {
+                        nearNodes.push_back(cellNodeIDs[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Cells may collide in hash, therefore same node could be found more than once.
+    std::sort(nearNodes.begin(),nearNodes.end());
+    nearNodes.erase(std::unique(nearNodes.begin(),nearNodes.end()),nearNodes.end());
+
+    return nearNodes;
+}
+
+uint RNodeGrid::findMergeMap(const std::vector<RNode> &nodes, double tolerance, std::vector<uint> &mergeMap)
+{
+    uint nn = uint(nodes.size());
+    uint nMerged = 0;
+
+    mergeMap.resize(nn);
+
+    RNodeGrid nodeGrid(tolerance,RNodeGrid::findCellSize(nodes,tolerance));
+    nodeGrid.reserve(nn);
+
+    RProgressInitialize("Finding near nodes");
+    for (uint i=0;i<nn;i++)
+    {
+        RProgressPrint(i,nn);
+        uint nodeID = nodeGrid.findNearNode(nodes,nodes[i]);
+        if (nodeID == RConstants::eod)
+        {
+            mergeMap[i] = i;
+            nodeGrid.insert(nodes[i],i);
+        }
+        else
+        {
+            mergeMap[i] = nodeID;
+            nMerged++;
+        }
+    }
+    RProgressFinalize("Done");
+
+    return nMerged;
+}
+
+uint RNodeGrid::findNodeBook(const std::vector<uint> &mergeMap, std::vector<uint> &nodeBook, std::vector<uint> &removeBook)
+{
+    uint nn = 0;
+
+    nodeBook.resize(mergeMap.size());
+    removeBook.resize(mergeMap.size());
+
+    for (uint i=0;i<mergeMap.size();i++)
+    {
+        if (mergeMap[i] == i)
+        {
+            nodeBook[i] = removeBook[i] = nn++;
+        }
+        else
+        {
+            removeBook[i] = RConstants::eod;
+        }
+    }
+    for (uint i=0;i<mergeMap.size();i++)
+    {
+        if (mergeMap[i] != i)
+        {
+            nodeBook[i] = nodeBook[mergeMap[i]];
+        }
+    }
+
+    return nn;
+}
+
+double RNodeGrid::findCellSize(const std::vector<RNode> &nodes, double tolerance)
+{
+    if (nodes.empty())
+    {
+        return std::max(tolerance,RNodeGrid::minCellSize);
+    }
+
+    double xmin = nodes[0].getX(), xmax = nodes[0].getX();
+    double ymin = nodes[0].getY(), ymax = nodes[0].getY();
+    double zmin = nodes[0].getZ(), zmax = nodes[0].getZ();
+
+    for (uint i=1;i<nodes.size();i++)
+    {
+        xmin = std::min(xmin,nodes[i].getX());
+        xmax = std::max(xmax,nodes[i].getX());
+        ymin = std::min(ymin,nodes[i].getY());
+        ymax = std::max(ymax,nodes[i].getY());
+        zmin = std::min(zmin,nodes[i].getZ());
+        zmax = std::max(zmax,nodes[i].getZ());
+    }
+
+    double size = std::max(std::max(xmax-xmin,ymax-ymin),zmax-zmin);
+
+    // Cell must not be smaller than tolerance and should not be so small that cell indexes lose meaning.
+    return std::max(std::max(tolerance,size * 1.0e-9),RNodeGrid::minCellSize);
+}
+
+int64_t RNodeGrid::findCellIndex(double value) const
+{
+    double index = std::floor(value / this->cellSize);
+    if (index > double(maxCellIndex))
+    {
+        return maxCellIndex;
+    }
+    if (index < -double(maxCellIndex))
+    {
+        return -maxCellIndex;
+    }
+    return int64_t(index);
+}
+
+uint64_t RNodeGrid::findCellKey(int64_t ix, int64_t iy, int64_t iz)
+{
+    return (uint64_t(ix) * 73856093ULL) ^ (uint64_t(iy) * 19349663ULL) ^ (uint64_t(iz) * 83492791ULL);
+}
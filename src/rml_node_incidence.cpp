@@ -0,0 +1,268 @@
+#include <algorithm>
+
+#include "rml_node_incidence.h"
+
+void RNodeIncidence::_init(const RNodeIncidence *pNodeIncidence)
+{
+    if (pNodeIncidence)
+    {
+        this->rowStart = pNodeIncidence->rowStart;
+        this->rowSize = pNodeIncidence->rowSize;
+        this->rowCapacity = pNodeIncidence->rowCapacity;
+        this->elementIDs = pNodeIncidence->elementIDs;
+        this->nNodes = pNodeIncidence->nNodes;
+        this->nElements = pNodeIncidence->nElements;
+        this->built.store(pNodeIncidence->built.load(std::memory_order_acquire),std::memory_order_release);
+    }
+}
+
+RNodeIncidence::RNodeIncidence()
+    : nNodes(0)
+    , nElements(0)
+    , built(false)
+{
+    this->_init();
+}
+
+RNodeIncidence::RNodeIncidence(const RNodeIncidence &nodeIncidence)
+{
+    this->_init(&nodeIncidence);
+}
+
+RNodeIncidence::~RNodeIncidence()
+{
+
+}
+
+RNodeIncidence &RNodeIncidence::operator =(const RNodeIncidence &nodeIncidence)
+{
+    this->_init(&nodeIncidence);
+    return (*this);
+}
+
+void RNodeIncidence::insert(uint nodeID, uint elementID)
+{
+    uint start = this->rowStart[nodeID];
+    uint size = this->rowSize[nodeID];
+
+    std::vector<uint>::iterator iter = std::lower_bound(this->elementIDs.begin() + start,
+                                                        this->elementIDs.begin() + start + size,
+                                                        elementID);
+    if (iter != this->elementIDs.begin() + start + size && *iter == elementID)
+    {
+        return;
+    }
+    uint position = uint(iter - this->elementIDs.begin());
+
+    if (size == this->rowCapacity[nodeID])
+    {
+        // Row is full, move it to the end of the array with doubled capacity.
+        uint capacity = 2 * size + 2;
+        uint newStart = uint(this->elementIDs.size());
+        this->elementIDs.resize(newStart + capacity,RConstants::eod);
+        for (uint i=0;i<size;i++)
+        {
+            this->elementIDs[newStart + i] = this->elementIDs[start + i];
+            this->elementIDs[start + i] = RConstants::eod;
+        }
+        position = newStart + (position - start);
+        start = newStart;
+        this->rowStart[nodeID] = start;
+        this->rowCapacity[nodeID] = capacity;
+    }
+
+    for (uint i=start+size;i>position;i--)
+    {
+        this->elementIDs[i] = this->elementIDs[i-1];
+    }
+    this->elementIDs[position] = elementID;
+    this->rowSize[nodeID]++;
+}
+
+void RNodeIncidence::erase(uint nodeID, uint elementID)
+{
+    uint start = this->rowStart[nodeID];
+    uint size = this->rowSize[nodeID];
+
+    std::vector<uint>::iterator iter = std::lower_bound(this->elementIDs.begin() + start,
+                                                        this->elementIDs.begin() + start + size,
+                                                        elementID);
+    if (iter == this->elementIDs.begin() + start + size || *iter != elementID)
+    {
+        return;
+    }
+
+    for (uint i=uint(iter - this->elementIDs.begin());i<start+size-1;i++)
+    {
+        this->elementIDs[i] = this->elementIDs[i+1];
+    }
+    this->elementIDs[start+size-1] = RConstants::eod;
+    this->rowSize[nodeID]--;
+}
+
+void RNodeIncidence::build(uint nNodes, const std::vector<RElement> &elements)
+{
+    this->clear();
+
+    this->rowStart.resize(nNodes,0);
+    this->rowSize.resize(nNodes,0);
+    this->rowCapacity.resize(nNodes,0);
+
+    // Count elements in each row, node repeated in one element is counted only once.
+    for (uint i=0;i<elements.size();i++)
+    {
+        const RElement &rElement = elements[i];
+        for (uint j=0;j<rElement.size();j++)
+        {
+            uint nodeID = rElement.getNodeId(j);
+            bool repeated = false;
+            for (uint k=0;k<j && !repeated;k++)
+            {
+                repeated = (rElement.getNodeId(k) == nodeID);
+            }
+            if (!repeated)
+            {
+                this->rowCapacity[nodeID]++;
+            }
+        }
+    }
+
+    // Reserve some space in each row for later modifications.
+    uint nEntries = 0;
+    for (uint i=0;i<nNodes;i++)
+    {
+        this->rowCapacity[i] += this->rowCapacity[i] / 4 + 1;
+        this->rowStart[i] = nEntries;
+        nEntries += this->rowCapacity[i];
+    }
+    this->elementIDs.resize(nEntries,RConstants::eod);
+
+    // Elements are visited in ascending order, therefore rows are sorted.
+    for (uint i=0;i<elements.size();i++)
+    {
+        const RElement &rElement = elements[i];
+        for (uint j=0;j<rElement.size();j++)
+        {
+            uint nodeID = rElement.getNodeId(j);
+            uint size = this->rowSize[nodeID];
+            if (size == 0 || this->elementIDs[this->rowStart[nodeID] + size - 1] != i)
+            {
+                this->elementIDs[this->rowStart[nodeID] + size] = i;
+                this->rowSize[nodeID]++;
+            }
+        }
+    }
+
+    this->nNodes = nNodes;
+    this->nElements = uint(elements.size());
+    this->built.store(true,std::memory_order_release);
+}
+
+void RNodeIncidence::clear(void)
+{
+    this->rowStart.clear();
+    this->rowSize.clear();
+    this->rowCapacity.clear();
+    this->elementIDs.clear();
+    this->nNodes = 0;
+    this->nElements = 0;
+    this->built.store(false,std::memory_order_release);
+}
+
+bool RNodeIncidence::isBuilt(void) const
+{
+    return this->built.load(std::memory_order_acquire);
+}
+
+uint RNodeIncidence::getNElements(uint nodeID) const
+{
+    return this->rowSize[nodeID];
+}
+
+std::vector<uint> RNodeIncidence::getElementIDs(uint nodeID) const
+{
+    std::vector<uint>::const_iterator iter = this->elementIDs.begin() + this->rowStart[nodeID];
+    return std::vector<uint>(iter,iter + this->rowSize[nodeID]);
+}
+
+void RNodeIncidence::addElement(const RElement &element)
+{
+    if (!this->isBuilt())
+    {
+        return;
+    }
+    for (uint i=0;i<element.size();i++)
+    {
+        this->insert(element.getNodeId(i),this->nElements);
+    }
+    this->nElements++;
+}
+
+void RNodeIncidence::setElement(uint elementID, const RElement &oldElement, const RElement &newElement)
+{
+    if (!this->isBuilt())
+    {
+        return;
+    }
+    for (uint i=0;i<oldElement.size();i++)
+    {
+        this->erase(oldElement.getNodeId(i),elementID);
+    }
+    for (uint i=0;i<newElement.size();i++)
+    {
+        this->insert(newElement.getNodeId(i),elementID);
+    }
+}
+
+void RNodeIncidence::removeElement(uint elementID, const RElement &element)
+{
+    if (!this->isBuilt())
+    {
+        return;
+    }
+    for (uint i=0;i<element.size();i++)
+    {
+        this->erase(element.getNodeId(i),elementID);
+    }
+
+    // Shifting IDs does not change order within rows.
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(this->elementIDs.size());i++)
+    {
+        uint &rElementID = this->elementIDs[uint(i)];
+        if (rElementID != RConstants::eod && rElementID > elementID)
+        {
+            rElementID--;
+        }
+    }
+    this->nElements--;
+}
+
+void RNodeIncidence::addNode(void)
+{
+    if (!this->isBuilt())
+    {
+        return;
+    }
+    this->rowStart.push_back(uint(this->elementIDs.size()));
+    this->rowSize.push_back(0);
+    this->rowCapacity.push_back(0);
+    this->nNodes++;
+}
+
+void RNodeIncidence::removeNode(uint nodeID)
+{
+    if (!this->isBuilt())
+    {
+        return;
+    }
+    if (this->rowSize[nodeID] > 0)
+    {
+        this->clear();
+        return;
+    }
+    this->rowStart.erase(this->rowStart.begin() + nodeID);
+    this->rowSize.erase(this->rowSize.begin() + nodeID);
+    this->rowCapacity.erase(this->rowCapacity.begin() + nodeID);
+    this->nNodes--;
+}
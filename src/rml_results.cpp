@@ -1,27 +1,40 @@
+#include <exception>
 #include <string>
 #include <vector>
 
+#include <QFileInfo>
+
 #include <rbl_error.h>
 #include <rbl_utils.h>
 
 #include "rml_results.h"
+#include "rml_file_io.h"
 
 
 void RResults::_init (const RResults *pResults)
 {
     this->nnodes = 0;
     this->nelements = 0;
+    this->deferredFileSize = 0;
+    this->nDeferred.store(0,std::memory_order_relaxed);
 
     if (pResults)
     {
 //        this->compTime = compTime;
-        this->setNVariables (pResults->getNVariables());
-        this->setNNodes (pResults->getNNodes());
-        this->setNElements (pResults->getNElements());
-        for (unsigned int i=0;i<this->getNVariables();i++)
+        this->nnodes = pResults->nnodes;
+        this->nelements = pResults->nelements;
+        this->deferredFileName = pResults->deferredFileName;
+        this->deferredFileVersion = pResults->deferredFileVersion;
+        this->deferredFileSize = pResults->deferredFileSize;
+        this->deferredFileModified = pResults->deferredFileModified;
+        // Deferred variables are copied as they are and loaded later from the same file.
+        // Source variables may be loaded concurrently.
+#pragma omp critical(RResults_loadVariable)
         {
-            this->setVariable(i, pResults->getVariable(i));
+            this->variables = pResults->variables;
+            this->deferredOffsets = pResults->deferredOffsets;
         }
+        this->updateNDeferred();
     }
 } /* RResults::_init */
 
@@ -42,6 +55,92 @@ RResults::~RResults()
 } /* RResults::~RResults */
 
 
+void RResults::loadVariable(unsigned int position) const
+{
+    // Lock is needed only while some variables are deferred.
+    if (this->nDeferred.load(std::memory_order_acquire) == 0)
+    {
+        return;
+    }
+    // Exception must not leave critical section, it is rethrown after it.
+    std::exception_ptr exception;
+#pragma omp critical(RResults_loadVariable)
+    {
+        if (!this->deferredOffsets.empty() && this->deferredOffsets[position] >= 0)
+        {
+            try
+            {
+                QFileInfo fileInfo(this->deferredFileName);
+                if (fileInfo.size() != this->deferredFileSize || fileInfo.lastModified() != this->deferredFileModified)
+                {
+                    throw RError(RError::Type::ReadFile,R_ERROR_REF,"File \'%s\' was modified after results were read.",this->deferredFileName.toUtf8().constData());
+                }
+
+                RFile inFile(this->deferredFileName,RFile::BINARY);
+
+                if (!inFile.open(QIODevice::ReadOnly))
+                {
+                    throw RError(RError::Type::OpenFile,R_ERROR_REF,"Failed to open the file \'%s\'.",this->deferredFileName.toUtf8().constData());
+                }
+                inFile.setVersion(this->deferredFileVersion);
+                if (!inFile.seek(this->deferredOffsets[position]))
+                {
+                    throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to find variable in the file \'%s\'.",this->deferredFileName.toUtf8().constData());
+                }
+                RVariable variable;
+                RFileIO::readBinary(inFile,variable);
+                if (variable.getType() != this->variables[position].getType())
+                {
+                    throw RError(RError::Type::ReadFile,R_ERROR_REF,"Unexpected variable found in the file \'%s\'.",this->deferredFileName.toUtf8().constData());
+                }
+                inFile.close();
+
+                this->variables[position] = variable;
+                this->deferredOffsets[position] = -1;
+                this->nDeferred.fetch_sub(1,std::memory_order_release);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+        }
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+} /* RResults::loadVariable */
+
+
+void RResults::setDeferredVariables(const QString &fileName, const RVersion &fileVersion, const std::vector<qint64> &offsets)
+{
+    R_ERROR_ASSERT (offsets.size() == this->variables.size());
+
+    QFileInfo fileInfo(fileName);
+
+    this->deferredFileName = fileName;
+    this->deferredFileVersion = fileVersion;
+    this->deferredFileSize = fileInfo.size();
+    this->deferredFileModified = fileInfo.lastModified();
+    this->deferredOffsets = offsets;
+    this->updateNDeferred();
+} /* RResults::setDeferredVariables */
+
+
+void RResults::updateNDeferred()
+{
+    uint n = 0;
+    for (uint i=0;i<this->deferredOffsets.size();i++)
+    {
+        if (this->deferredOffsets[i] >= 0)
+        {
+            n++;
+        }
+    }
+    this->nDeferred.store(n,std::memory_order_release);
+} /* RResults::updateNDeferred */
+
+
 RResults &RResults::operator = (const RResults &results)
 {
     this->_init (&results);
@@ -56,6 +155,8 @@ void RResults::clearResults()
         this->variables[i].clearValues();
     }
     this->variables.clear();
+    this->deferredOffsets.clear();
+    this->updateNDeferred();
 } /* RResults::clearResults */
 
 
@@ -80,12 +181,47 @@ unsigned int RResults::getNVariables() const
 void RResults::setNVariables (unsigned int nvariables)
 {
     this->variables.resize(nvariables);
+    if (!this->deferredOffsets.empty())
+    {
+        this->deferredOffsets.resize(nvariables,-1);
+        this->updateNDeferred();
+    }
 } /* RResults::set_n_variables */
 
 
+bool RResults::isVariableLoaded(unsigned int position) const
+{
+    R_ERROR_ASSERT (position < this->getNVariables());
+    if (this->nDeferred.load(std::memory_order_acquire) == 0)
+    {
+        return true;
+    }
+    bool loaded = true;
+#pragma omp critical(RResults_loadVariable)
+    {
+        loaded = (this->deferredOffsets.empty() || this->deferredOffsets[position] < 0);
+    }
+    return loaded;
+} /* RResults::isVariableLoaded */
+
+
+void RResults::loadVariables() const
+{
+    for (unsigned int i=0;i<this->getNVariables();i++)
+    {
+        this->loadVariable(i);
+    }
+#pragma omp critical(RResults_loadVariable)
+    {
+        this->deferredOffsets.clear();
+    }
+} /* RResults::loadVariables */
+
+
 const RVariable &RResults::getVariable (unsigned int position) const
 {
     R_ERROR_ASSERT (position < this->getNVariables());
+    this->loadVariable(position);
     return this->variables[position];
 } /* RResults::getVariable */
 
@@ -93,6 +229,7 @@ const RVariable &RResults::getVariable (unsigned int position) const
 RVariable &RResults::getVariable (unsigned int position)
 {
     R_ERROR_ASSERT (position < this->getNVariables());
+    this->loadVariable(position);
     return this->variables[position];
 } /* RResults::getVariable */
 
@@ -101,7 +238,7 @@ unsigned int RResults::findVariable(RVariableType variableType) const
 {
     for (unsigned int i=0;i<this->getNVariables();i++)
     {
-        if (this->getVariable(i).getType() == variableType)
+        if (this->variables[i].getType() == variableType)
         {
             return i;
         }
@@ -134,6 +271,10 @@ unsigned int RResults::addVariable(const RVariable &variable)
     if (variablePosition == RConstants::eod)
     {
         this->variables.push_back(variable);
+        if (!this->deferredOffsets.empty())
+        {
+            this->deferredOffsets.push_back(-1);
+        }
         variablePosition = uint(this->variables.size()-1);
     }
     else
@@ -149,6 +290,11 @@ void RResults::setVariable (unsigned int     position,
 {
     R_ERROR_ASSERT (position < this->getNVariables());
     this->variables[position] = variable;
+    if (!this->deferredOffsets.empty())
+    {
+        this->deferredOffsets[position] = -1;
+        this->updateNDeferred();
+    }
 } /* RResults::setVariable */
 
 
@@ -156,15 +302,33 @@ void RResults::removeVariable(uint position)
 {
     R_ERROR_ASSERT (position < this->getNVariables());
     this->variables.erase(this->variables.begin() + position);
+    if (!this->deferredOffsets.empty())
+    {
+        this->deferredOffsets.erase(this->deferredOffsets.begin() + position);
+        this->updateNDeferred();
+    }
 } /* RResults::removeVariable */
 
 
 void RResults::removeAllVariables()
 {
     this->variables.clear();
+    this->deferredOffsets.clear();
+    this->updateNDeferred();
 } /* RResults::removeAllVariables */
 
 
+void RResults::setVariableCompression(RVariableCompressionType compressionType, double compressionTolerance)
+{
+    // Deferred variables would otherwise receive compression stored in file when loaded.
+    this->loadVariables();
+    for (uint i=0;i<this->variables.size();i++)
+    {
+        this->variables[i].setCompression(compressionType,compressionTolerance);
+    }
+} /* RResults::setVariableCompression */
+
+
 unsigned int RResults::getNNodes() const
 {
     return this->nnodes;
@@ -175,6 +339,8 @@ void RResults::setNNodes (unsigned int nnodes)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     this->nnodes = nnodes;
 
     for (iter = this->variables.begin();
@@ -193,6 +359,8 @@ void RResults::addNode (double value)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     for (iter = this->variables.begin();
          iter != this->variables.end();
          ++iter)
@@ -211,6 +379,8 @@ void RResults::removeNode (unsigned int position)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     R_ERROR_ASSERT (position < this->getNNodes());
 
     for (iter = this->variables.begin();
@@ -227,6 +397,33 @@ void RResults::removeNode (unsigned int position)
 } /* RResults::removeNode */
 
 
+void RResults::removeNodes(const std::vector<uint> &nodeBook)
+{
+    std::vector<RVariable>::iterator iter;
+
+    this->loadVariables();
+
+    for (iter = this->variables.begin();
+         iter != this->variables.end();
+         ++iter)
+    {
+        if (iter->getApplyType() == R_VARIABLE_APPLY_NODE)
+        {
+            iter->removeValues(nodeBook);
+        }
+    }
+
+    this->nnodes = 0;
+    for (uint i=0;i<uint(nodeBook.size());i++)
+    {
+        if (nodeBook[i] != RConstants::eod)
+        {
+            this->nnodes++;
+        }
+    }
+} /* RResults::removeNodes */
+
+
 unsigned int RResults::getNElements() const
 {
     return this->nelements;
@@ -237,6 +434,8 @@ void RResults::setNElements (unsigned int nelements)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     this->nelements = nelements;
 
     for (iter = this->variables.begin();
@@ -255,6 +454,8 @@ void RResults::addElement (double value)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     for (iter = this->variables.begin();
          iter != this->variables.end();
          ++iter)
@@ -273,6 +474,8 @@ void RResults::removeElement (unsigned int position)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     R_ERROR_ASSERT (position < this->getNElements());
 
     for (iter = this->variables.begin();
@@ -292,6 +495,8 @@ void RResults::removeElements(const std::vector<uint> &elementBook)
 {
     std::vector<RVariable>::iterator iter;
 
+    this->loadVariables();
+
     for (iter = this->variables.begin();
          iter != this->variables.end();
          ++iter)
@@ -1,6 +1,8 @@
 #include "rml_stream_line.h"
 
 const QString RStreamLine::defaultName("Stream line");
+const double RStreamLine::defaultTolerance = 1.0e-3;
+const uint RStreamLine::maxSteps = 100000;
 
 void RStreamLine::_init(const RStreamLine *pStreamLine)
 {
@@ -8,11 +10,15 @@ void RStreamLine::_init(const RStreamLine *pStreamLine)
     {
         this->variableType = pStreamLine->variableType;
         this->position = pStreamLine->position;
+        this->integrator = pStreamLine->integrator;
+        this->tolerance = pStreamLine->tolerance;
     }
 }
 
 RStreamLine::RStreamLine()
     : variableType(R_VARIABLE_NONE)
+    , integrator(R_STREAM_LINE_INTEGRATOR_ELEMENT_WALK)
+    , tolerance(RStreamLine::defaultTolerance)
 {
     this->name = RStreamLine::defaultName;
     this->_init();
@@ -54,3 +60,55 @@ void RStreamLine::setPosition(const RR3Vector &position)
 {
     this->position = position;
 }
+
+RStreamLineIntegrator RStreamLine::getIntegrator(void) const
+{
+    return this->integrator;
+}
+
+void RStreamLine::setIntegrator(RStreamLineIntegrator integrator)
+{
+    this->integrator = integrator;
+}
+
+double RStreamLine::getTolerance(void) const
+{
+    return this->tolerance;
+}
+
+void RStreamLine::setTolerance(double tolerance)
+{
+    this->tolerance = tolerance;
+}
+
+std::vector<RR3Vector> RStreamLine::findRakePositions(const RR3Vector &start, const RR3Vector &end, uint nPositions)
+{
+    std::vector<RR3Vector> positions(nPositions);
+    for (uint i=0;i<nPositions;i++)
+    {
+        double t = (nPositions > 1) ? double(i) / double(nPositions - 1) : 0.5;
+        for (uint k=0;k<3;k++)
+        {
+            positions[i][k] = start[k] + t * (end[k] - start[k]);
+        }
+    }
+    return positions;
+}
+
+std::vector<RR3Vector> RStreamLine::findGridPositions(const RR3Vector &origin, const RR3Vector &edge1, const RR3Vector &edge2, uint nPositions1, uint nPositions2)
+{
+    std::vector<RR3Vector> positions(nPositions1 * nPositions2);
+    for (uint i=0;i<nPositions1;i++)
+    {
+        double t1 = (nPositions1 > 1) ? double(i) / double(nPositions1 - 1) : 0.5;
+        for (uint j=0;j<nPositions2;j++)
+        {
+            double t2 = (nPositions2 > 1) ? double(j) / double(nPositions2 - 1) : 0.5;
+            for (uint k=0;k<3;k++)
+            {
+                positions[i*nPositions2+j][k] = origin[k] + t1 * edge1[k] + t2 * edge2[k];
+            }
+        }
+    }
+    return positions;
+}
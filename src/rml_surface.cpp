@@ -3,6 +3,7 @@
 #include <rbl_error.h>
 
 #include "rml_element.h"
+#include "rml_element_tree.h"
 #include "rml_surface.h"
 #include "rml_mesh_generator.h"
 
@@ -87,42 +88,47 @@ std::vector<bool> RSurface::pointsInside(const std::vector<RNode> &nodes, const
         }
     }
 
+    RElementTree volumeTree;
+    volumeTree.build(volumeNodes,volumeElements);
+
+    RElementTree surfaceTree;
+    if (!includeSurface)
+    {
+        std::vector<uint> surfaceElementIDs(this->size());
+        for (uint i=0;i<this->size();i++)
+        {
+            surfaceElementIDs[i] = this->get(i);
+        }
+        surfaceTree.build(nodes,elements,surfaceElementIDs);
+    }
+
     std::vector<bool> areInside;
     areInside.resize(points.size(),false);
 
-    for (uint i=0;i<points.size();i++)
-    {
-        RNode node(points[i]);
-        bool isInside = false;
+    std::vector<char> insideBook(points.size(),false);
 
 #pragma omp parallel for default(shared)
-        for (int64_t j=0;j<int64_t(volumeElements.size());j++)
-        {
-#pragma omp flush (isInside)
-            if (!isInside)
-            {
-                if (volumeElements[j].isInside(volumeNodes,node))
-                {
-                    isInside = true;
-#pragma omp flush (isInside)
-                }
-            }
-        }
+    for (int64_t i=0;i<int64_t(points.size());i++)
+    {
+        RNode node(points[uint(i)]);
+
+        bool isInside = (volumeTree.findElementID(volumeNodes,volumeElements,node) != RConstants::eod);
 
-        if (!includeSurface)
+        if (isInside && !includeSurface)
         {
             // Check that point is not on the surface.
-            for (uint j=0;j<this->size();j++)
+            if (surfaceTree.findElementID(nodes,elements,node) != RConstants::eod)
             {
-                if (elements[this->get(j)].isInside(nodes,node))
-                {
-                    isInside = false;
-                    break;
-                }
+                isInside = false;
             }
         }
 
-        areInside[i] = isInside;
+        insideBook[uint(i)] = isInside;
+    }
+
+    for (uint i=0;i<points.size();i++)
+    {
+        areInside[i] = insideBook[i];
     }
 
     return areInside;
@@ -287,70 +287,129 @@ void RTetGen::exportMesh(RModel &model, bool keepResults) const
     }
 
     // Interpolate element results.
+    // Old mesh is only read here, const access keeps its search structures valid.
+    const RModel &rOldModel = model;
     std::vector<RVariable> variables;
 
-    if (keepResults && model.getNVariables() > 0)
+    if (keepResults && rOldModel.getNVariables() > 0)
     {
         RLogger::info("Interpolating results\n");
         RLogger::indent();
 
+        bool hasNodeVariables = false;
+        bool hasElementVariables = false;
+        for (uint i=0;i<rOldModel.getNVariables();i++)
+        {
+            hasNodeVariables = hasNodeVariables || (rOldModel.getVariable(i).getApplyType() == R_VARIABLE_APPLY_NODE);
+            hasElementVariables = hasElementVariables || (rOldModel.getVariable(i).getApplyType() == R_VARIABLE_APPLY_ELEMENT);
+        }
+
+        // Locate new nodes in old mesh and find their interpolation ratios only once for all variables.
+        std::vector<uint> nodeElementIDs;
+        std::vector<RRVector> nodeRatios;
+        if (hasNodeVariables)
+        {
+            RLogger::info("Locating new nodes\n");
+            std::vector<RNode> nodes(uint(this->numberofpoints));
+            for (int64_t j=0;j<this->numberofpoints;j++)
+            {
+                nodes[uint(j)] = RNode(this->pointlist[3*j+0],this->pointlist[3*j+1],this->pointlist[3*j+2]);
+            }
+
+            std::vector<RRVector> volumes;
+            nodeElementIDs = rOldModel.findElementsContaining(nodes,R_ENTITY_GROUP_ELEMENT,volumes);
+
+            nodeRatios.resize(nodes.size());
+#pragma omp parallel for default(shared)
+            for (int64_t j=0;j<int64_t(nodes.size());j++)
+            {
+                if (nodeElementIDs[uint(j)] != RConstants::eod)
+                {
+                    rOldModel.getElement(nodeElementIDs[uint(j)]).findInterpolationRatios(rOldModel.getNodes(),nodes[uint(j)],volumes[uint(j)],nodeRatios[uint(j)]);
+                }
+            }
+        }
+
+        // Locate centers of new tetrahedra in old mesh.
+        std::vector<uint> tetrahedraElementIDs;
+        if (hasElementVariables)
+        {
+            RLogger::info("Locating new elements\n");
+            std::vector<RNode> centers(uint(this->numberoftetrahedra));
+#pragma omp parallel for default(shared)
+            for (int64_t j=0;j<this->numberoftetrahedra;j++)
+            {
+                double x = 0.0, y = 0.0, z = 0.0;
+                for (uint k=0;k<4;k++)
+                {
+                    int n = this->tetrahedronlist[4*j+k] - this->firstnumber;
+                    x += this->pointlist[3*n+0];
+                    y += this->pointlist[3*n+1];
+                    z += this->pointlist[3*n+2];
+                }
+                centers[uint(j)] = RNode(x/4.0,y/4.0,z/4.0);
+            }
+
+            std::vector<RRVector> volumes;
+            tetrahedraElementIDs = rOldModel.findElementsContaining(centers,R_ENTITY_GROUP_ELEMENT,volumes);
+        }
+
         RProgressInitialize("Interpolating results");
-        for (uint i=0;i<model.getNVariables();i++)
+        for (uint i=0;i<rOldModel.getNVariables();i++)
         {
-            RProgressPrint(i,model.getNVariables());
-            RVariable variable = model.getVariable(i);
+            RProgressPrint(i,rOldModel.getNVariables());
+            const RVariable &rOldVariable = rOldModel.getVariable(i);
+            RVariable variable = rOldVariable;
             RLogger::info("Interpolating %s\n",variable.getName().toUtf8().constData());
-            RLogger::indent();
-            if (model.getVariable(i).getApplyType() == R_VARIABLE_APPLY_NODE)
+            if (rOldVariable.getApplyType() == R_VARIABLE_APPLY_NODE)
             {
                 variable.resize(variable.getNVectors(),uint(this->numberofpoints));
 #pragma omp parallel for default(shared)
                 for (int64_t j=0;j<this->numberofpoints;j++)
                 {
-                    RNode node(this->pointlist[3*j+0],this->pointlist[3*j+1],this->pointlist[3*j+2]);
-                    RRVector values = model.getInterpolatedResultsValues(variable.getType(),node);
-                    for (uint k=0;k<values.size();k++)
+                    uint elementID = nodeElementIDs[uint(j)];
+                    if (elementID == RConstants::eod)
+                    {
+                        continue;
+                    }
+                    const RElement &rElement = rOldModel.getElement(elementID);
+                    const RRVector &ratios = nodeRatios[uint(j)];
+                    for (uint k=0;k<variable.getNVectors();k++)
                     {
-                        variable.setValue(k,uint(j),values[k]);
+                        double value = 0.0;
+                        for (uint l=0;l<ratios.size();l++)
+                        {
+                            value += ratios[l] * rOldVariable.getValue(k,rElement.getNodeId(l));
+                        }
+                        variable.setValue(k,uint(j),value);
                     }
                 }
                 variables.push_back(variable);
             }
-            else if (model.getVariable(i).getApplyType() == R_VARIABLE_APPLY_ELEMENT)
+            else if (rOldVariable.getApplyType() == R_VARIABLE_APPLY_ELEMENT)
             {
                 variable.resize(variable.getNVectors(),  numberOfPointElements
                                                        + numberOfLineElements
                                                        + uint(this->numberoftrifaces)
                                                        + uint(this->numberoftetrahedra));
+
+                uint offset = numberOfPointElements + numberOfLineElements + uint(this->numberoftrifaces);
+
 #pragma omp parallel for default(shared)
                 for (int64_t j=0;j<this->numberoftetrahedra;j++)
                 {
-                    int n1 = this->tetrahedronlist[4*j+0] - this->firstnumber;
-                    int n2 = this->tetrahedronlist[4*j+1] - this->firstnumber;
-                    int n3 = this->tetrahedronlist[4*j+2] - this->firstnumber;
-                    int n4 = this->tetrahedronlist[4*j+3] - this->firstnumber;
-
-                    RNode node1(this->pointlist[3*n1+0],this->pointlist[3*n1+1],this->pointlist[3*n1+2]);
-                    RNode node2(this->pointlist[3*n2+0],this->pointlist[3*n2+1],this->pointlist[3*n2+2]);
-                    RNode node3(this->pointlist[3*n3+0],this->pointlist[3*n3+1],this->pointlist[3*n3+2]);
-                    RNode node4(this->pointlist[3*n4+0],this->pointlist[3*n4+1],this->pointlist[3*n4+2]);
-
-                    RNode node((node1.getX()+node2.getX()+node3.getX()+node4.getX())/4.0,
-                               (node1.getY()+node2.getY()+node3.getY()+node4.getY())/4.0,
-                               (node1.getZ()+node2.getZ()+node3.getZ()+node4.getZ())/4.0);
-
-                    RRVector values = model.getInterpolatedResultsValues(variable.getType(),node);
-
-                    uint offset = numberOfPointElements + numberOfLineElements + uint(this->numberoftrifaces);
-
-                    for (uint k=0;k<values.size();k++)
+                    uint elementID = tetrahedraElementIDs[uint(j)];
+                    if (elementID == RConstants::eod)
+                    {
+                        continue;
+                    }
+                    for (uint k=0;k<variable.getNVectors();k++)
                     {
-                        variable.setValue(k,offset+uint(j),values[k]);
+                        variable.setValue(k,offset+uint(j),rOldVariable.getValue(k,elementID));
                     }
                 }
                 variables.push_back(variable);
             }
-            RLogger::unindent();
         }
         RProgressFinalize();
         RLogger::unindent();
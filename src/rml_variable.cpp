@@ -1,12 +1,15 @@
 #include <QString>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 
 #include <rbl_error.h>
 
 #include "rml_problem_type.h"
 #include "rml_variable.h"
 
+const uint RVariable::blockSize = 16384;
+
 typedef struct _RVariableDesc
 {
     QString           id;
@@ -129,6 +132,10 @@ const RVariableDesc variableDesc [R_VARIABLE_N_TYPES] =
 
 
 RVariable::RVariable (RVariableType type, RVariableApplyType applyType)
+    : compressionType(R_VARIABLE_COMPRESSION_NONE)
+    , compressionTolerance(0.0)
+    , statisticsValid(false)
+    , magnitudesValid(false)
 {
     this->setType(type);
     this->setApplyType(applyType);
@@ -158,10 +165,120 @@ void RVariable::_init (const RVariable *pVariable)
         this->units = pVariable->units;
         this->values = pVariable->values;
         this->variableData = pVariable->variableData;
+        this->compressionType = pVariable->compressionType;
+        this->compressionTolerance = pVariable->compressionTolerance;
+        this->statistics = pVariable->statistics;
+        this->statisticsValid.store(pVariable->statisticsValid.load(std::memory_order_acquire),std::memory_order_release);
+        this->magnitudes = pVariable->magnitudes;
+        this->magnitudesValid.store(pVariable->magnitudesValid.load(std::memory_order_acquire),std::memory_order_release);
     }
 } /* RVariable::_init */
 
 
+void RVariable::findStatistics(void) const
+{
+    // Lock only if statistics need to be computed, once computed they are only read.
+    if (this->statisticsValid.load(std::memory_order_acquire))
+    {
+        return;
+    }
+#pragma omp critical (RVariableStatistics)
+    {
+        if (!this->statisticsValid.load(std::memory_order_relaxed))
+        {
+            // Magnitudes are published by getMagnitudes() under different lock.
+            bool useMagnitudes = this->magnitudesValid.load(std::memory_order_acquire);
+            uint nVectors = this->getNVectors();
+            uint nValues = this->getNValues();
+            uint nStatistics = nVectors + 1;
+            int64_t nBlocks = (int64_t(nValues) + RVariable::blockSize - 1) / RVariable::blockSize;
+
+            // Mean value of block statistics holds sum of values until blocks are combined.
+            std::vector<RVariableStatistics> blockStatistics(size_t(nBlocks)*nStatistics);
+
+#pragma omp parallel for default(shared)
+            for (int64_t i=0;i<nBlocks;i++)
+            {
+                uint first = uint(i) * RVariable::blockSize;
+                uint last = std::min(nValues,first + RVariable::blockSize);
+                RVariableStatistics *pStatistics = &blockStatistics[size_t(i)*nStatistics];
+
+                for (uint j=0;j<nVectors;j++)
+                {
+                    const RValueVector &valueVector = this->values[j];
+                    double minValue = valueVector[first];
+                    double maxValue = valueVector[first];
+                    double sumValue = 0.0;
+                    for (uint k=first;k<last;k++)
+                    {
+                        double value = valueVector[k];
+                        minValue = std::min(minValue,value);
+                        maxValue = std::max(maxValue,value);
+                        sumValue += value;
+                    }
+                    pStatistics[j].minValue = minValue;
+                    pStatistics[j].maxValue = maxValue;
+                    pStatistics[j].meanValue = sumValue;
+                }
+
+                if (nVectors == 1)
+                {
+                    pStatistics[1] = pStatistics[0];
+                    continue;
+                }
+
+                double minValue = this->findMagnitude(first);
+                double maxValue = minValue;
+                double sumValue = 0.0;
+                for (uint k=first;k<last;k++)
+                {
+                    double value = useMagnitudes ? this->magnitudes[k] : this->findMagnitude(k);
+                    minValue = std::min(minValue,value);
+                    maxValue = std::max(maxValue,value);
+                    sumValue += value;
+                }
+                pStatistics[nVectors].minValue = minValue;
+                pStatistics[nVectors].maxValue = maxValue;
+                pStatistics[nVectors].meanValue = sumValue;
+            }
+
+            // Blocks are combined in fixed order so that result does not depend on number of threads.
+            std::vector<RVariableStatistics> statistics(nStatistics);
+            for (uint j=0;j<nStatistics;j++)
+            {
+                statistics[j].minValue = statistics[j].maxValue = statistics[j].meanValue = 0.0;
+                for (int64_t i=0;i<nBlocks;i++)
+                {
+                    const RVariableStatistics &rStatistics = blockStatistics[size_t(i)*nStatistics+j];
+                    statistics[j].minValue = (i == 0) ? rStatistics.minValue : std::min(statistics[j].minValue,rStatistics.minValue);
+                    statistics[j].maxValue = (i == 0) ? rStatistics.maxValue : std::max(statistics[j].maxValue,rStatistics.maxValue);
+                    statistics[j].meanValue += rStatistics.meanValue;
+                }
+                if (nValues > 0)
+                {
+                    statistics[j].meanValue /= double(nValues);
+                }
+            }
+
+            this->statistics.swap(statistics);
+            this->statisticsValid.store(true,std::memory_order_release);
+        }
+    }
+} /* RVariable::findStatistics */
+
+
+double RVariable::findMagnitude(unsigned int valpos) const
+{
+    double tmpValue = 0.0;
+    for (unsigned int i=0;i<this->getNVectors();i++)
+    {
+        double value = this->values[i][valpos];
+        tmpValue += value*value;
+    }
+    return std::sqrt(tmpValue);
+} /* RVariable::findMagnitude */
+
+
 RVariableType RVariable::getType (void) const
 {
     return this->type;
@@ -235,6 +352,7 @@ unsigned int RVariable::getNValues (void) const
 
 void RVariable::clearValues(void)
 {
+    this->invalidateStatistics();
     for (unsigned int i=0;i<this->values.size();i++)
     {
         this->values[i].fill(0.0);
@@ -246,6 +364,7 @@ void RVariable::resize (unsigned int nvectors,
                         unsigned int nvalues,
                         bool fillInitValues)
 {
+    this->invalidateStatistics();
     this->values.resize (nvectors);
     for (unsigned int i=0;i<nvectors;i++)
     {
@@ -267,14 +386,13 @@ double RVariable::getValue(unsigned int valpos) const
     {
         return this->values[0][valpos];
     }
+    else if (this->magnitudesValid.load(std::memory_order_acquire))
+    {
+        return this->magnitudes[valpos];
+    }
     else
     {
-        double tmpValue = 0.0;
-        for (unsigned int i=0;i<this->getNVectors();i++)
-        {
-            tmpValue += this->getValue(i,valpos)*this->getValue(i,valpos);
-        }
-        return std::sqrt(tmpValue);
+        return this->findMagnitude(valpos);
     }
 } /* RVariable::getValue */
 
@@ -333,90 +451,85 @@ RRVector RVariable::getValues(unsigned int vecpos) const
 
 double RVariable::getMinValue(void) const
 {
-    double minValue = 0.0;
-    bool firstValue = true;
-
-    for (unsigned int i=0;i<this->getNValues();i++)
-    {
-        if (firstValue)
-        {
-            minValue = this->getValue(i);
-            firstValue = false;
-        }
-        else
-        {
-            minValue = std::min(minValue,this->getValue(i));
-        }
-    }
-
-    return minValue;
+    this->findStatistics();
+    return this->statistics[this->getNVectors()].minValue;
 } /* RVariable::getMinValue */
 
 
 double RVariable::getMinValue(unsigned int vecpos) const
 {
-    double minValue = 0.0;
-    bool firstValue = true;
-
-    for (unsigned int i=0;i<this->getNValues();i++)
-    {
-        if (firstValue)
-        {
-            minValue = this->getValue(vecpos,i);
-            firstValue = false;
-        }
-        else
-        {
-            minValue = std::min(minValue,this->getValue(vecpos,i));
-        }
-    }
-
-    return minValue;
+    R_ERROR_ASSERT (vecpos < this->getNVectors());
+    this->findStatistics();
+    return this->statistics[vecpos].minValue;
 } /* RVariable::getMinValue */
 
 
 double RVariable::getMaxValue(void) const
 {
-    double maxValue = 0.0;
-    bool firstValue = true;
+    this->findStatistics();
+    return this->statistics[this->getNVectors()].maxValue;
+} /* RVariable::getMaxValue */
 
-    for (unsigned int i=0;i<this->getNValues();i++)
-    {
-        if (firstValue)
-        {
-            maxValue = this->getValue(i);
-            firstValue = false;
-        }
-        else
-        {
-            maxValue = std::max(maxValue,this->getValue(i));
-        }
-    }
 
-    return maxValue;
+double RVariable::getMaxValue(unsigned int vecpos) const
+{
+    R_ERROR_ASSERT (vecpos < this->getNVectors());
+    this->findStatistics();
+    return this->statistics[vecpos].maxValue;
 } /* RVariable::getMaxValue */
 
 
-double RVariable::getMaxValue(unsigned int vecpos) const
+double RVariable::getMeanValue(void) const
 {
-    double maxValue = 0.0;
-    bool firstValue = true;
+    this->findStatistics();
+    return this->statistics[this->getNVectors()].meanValue;
+} /* RVariable::getMeanValue */
 
-    for (unsigned int i=0;i<this->getNValues();i++)
+
+double RVariable::getMeanValue(unsigned int vecpos) const
+{
+    R_ERROR_ASSERT (vecpos < this->getNVectors());
+    this->findStatistics();
+    return this->statistics[vecpos].meanValue;
+} /* RVariable::getMeanValue */
+
+
+const RRVector &RVariable::getMagnitudes(void) const
+{
+    // Lock only if magnitudes need to be computed, once computed they are only read.
+    if (!this->magnitudesValid.load(std::memory_order_acquire))
     {
-        if (firstValue)
-        {
-            maxValue = this->getValue(vecpos,i);
-            firstValue = false;
-        }
-        else
+#pragma omp critical (RVariableMagnitudes)
         {
-            maxValue = std::max(maxValue,this->getValue(vecpos,i));
+            if (!this->magnitudesValid.load(std::memory_order_relaxed))
+            {
+                int64_t nValues = int64_t(this->getNValues());
+                this->magnitudes.resize(nValues);
+#pragma omp parallel for default(shared)
+                for (int64_t i=0;i<nValues;i++)
+                {
+                    this->magnitudes[uint(i)] = (this->getNVectors() == 1) ? this->values[0][uint(i)] : this->findMagnitude(uint(i));
+                }
+                this->magnitudesValid.store(true,std::memory_order_release);
+            }
         }
     }
+    return this->magnitudes;
+} /* RVariable::getMagnitudes */
 
-    return maxValue;
-} /* RVariable::getMaxValue */
+
+void RVariable::invalidateStatistics(void)
+{
+    // Called for every set value, shared flags are written only if they are set.
+    if (this->statisticsValid.load(std::memory_order_relaxed))
+    {
+        this->statisticsValid.store(false,std::memory_order_release);
+    }
+    if (this->magnitudesValid.load(std::memory_order_relaxed))
+    {
+        this->magnitudesValid.store(false,std::memory_order_release);
+    }
+} /* RVariable::invalidateStatistics */
 
 
 void RVariable::setValue (unsigned int vecpos,
@@ -426,11 +539,14 @@ void RVariable::setValue (unsigned int vecpos,
     R_ERROR_ASSERT (vecpos < this->getNVectors ());
     R_ERROR_ASSERT (valpos < this->getNValues ());
     this->values[vecpos][valpos] = value;
+    this->invalidateStatistics();
 } /* RVariable::setValue */
 
 
 void RVariable::addValue (double value)
 {
+    this->invalidateStatistics();
+
     std::vector<RValueVector>::iterator iter;
 
     for (iter = this->values.begin();
@@ -444,6 +560,8 @@ void RVariable::addValue (double value)
 
 void RVariable::removeValue (unsigned int valpos)
 {
+    this->invalidateStatistics();
+
     std::vector<RValueVector>::iterator iter;
 
     for (iter = this->values.begin();
@@ -456,7 +574,10 @@ void RVariable::removeValue (unsigned int valpos)
 
 
 void RVariable::removeValues(const std::vector<uint> &valueBook)
-{    std::vector<RValueVector>::iterator iter;
+{
+     this->invalidateStatistics();
+
+     std::vector<RValueVector>::iterator iter;
 
      for (iter = this->values.begin();
           iter != this->values.end();
@@ -486,6 +607,26 @@ void RVariable::setVariableData(RVariableData &variableData)
 } /* RVariable::setVariableData */
 
 
+RVariableCompressionType RVariable::getCompressionType(void) const
+{
+    return this->compressionType;
+} /* RVariable::getCompressionType */
+
+
+double RVariable::getCompressionTolerance(void) const
+{
+    return this->compressionTolerance;
+} /* RVariable::getCompressionTolerance */
+
+
+void RVariable::setCompression(RVariableCompressionType compressionType, double compressionTolerance)
+{
+    R_ERROR_ASSERT (R_VARIABLE_COMPRESSION_TYPE_IS_VALID (compressionType));
+    this->compressionType = compressionType;
+    this->compressionTolerance = std::max(compressionTolerance,0.0);
+} /* RVariable::setCompression */
+
+
 RVariable & RVariable::operator = (const RVariable &variable)
 {
     this->_init (&variable);
@@ -0,0 +1,80 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <rbl_error.h>
+
+#include "rml_variable_compression.h"
+
+const int RVariableCompression::compressionLevel = 1;
+
+//! Number of mantissa bits of double value.
+static const int nMantissaBits = 52;
+
+//! Mask of exponent bits of double value.
+static const quint64 exponentMask = quint64(0x7FF) << nMantissaBits;
+
+int RVariableCompression::findMantissaBits(double tolerance)
+{
+    if (!(tolerance > 0.0))
+    {
+        return nMantissaBits;
+    }
+    double nBits = std::ceil(-std::log2(tolerance));
+    if (nBits <= 0.0)
+    {
+        return 0;
+    }
+    if (nBits >= double(nMantissaBits))
+    {
+        return nMantissaBits;
+    }
+    return int(nBits);
+}
+
+QByteArray RVariableCompression::compress(const double *values, qsizetype n, double tolerance)
+{
+    quint64 truncateMask = ~((quint64(1) << (nMantissaBits - RVariableCompression::findMantissaBits(tolerance))) - 1);
+
+    QByteArray shuffled(n*qsizetype(sizeof(double)),Qt::Uninitialized);
+    uchar *planes = (uchar*)shuffled.data();
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(n);i++)
+    {
+        quint64 bits = 0;
+        std::memcpy(&bits,&values[i],sizeof(double));
+        // Infinity and NaN are kept untouched.
+        if ((bits & exponentMask) != exponentMask)
+        {
+            bits &= truncateMask;
+        }
+        for (int64_t j=0;j<int64_t(sizeof(double));j++)
+        {
+            planes[j*n+i] = uchar(bits >> (8*j));
+        }
+    }
+
+    return qCompress(shuffled,RVariableCompression::compressionLevel);
+}
+
+void RVariableCompression::decompress(const QByteArray &data, double *values, qsizetype n)
+{
+    QByteArray shuffled(qUncompress(data));
+    if (shuffled.size() != n*qsizetype(sizeof(double)))
+    {
+        throw RError(RError::Type::ReadFile,R_ERROR_REF,"Failed to decompress block of %lld double values.",(long long)n);
+    }
+    const uchar *planes = (const uchar*)shuffled.constData();
+
+#pragma omp parallel for default(shared)
+    for (int64_t i=0;i<int64_t(n);i++)
+    {
+        quint64 bits = 0;
+        for (int64_t j=0;j<int64_t(sizeof(double));j++)
+        {
+            bits |= quint64(planes[j*n+i]) << (8*j);
+        }
+        std::memcpy(&values[i],&bits,sizeof(double));
+    }
+}